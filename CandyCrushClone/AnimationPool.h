@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Easing.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Identifies a track. Ids are never reused, so they can be used to tell which track a piece of state belongs to
+using AnimationTrackId = uint32_t;
+
+// Any number of independent animation tracks, each with its own duration, easing and user data.
+// The tracks are stored in contiguous arrays (structure of arrays) and finished tracks are swapped out of the active
+// range, so an update only touches the active tracks. The storage of finished tracks is reused by the next ones
+// (including the capacity of any containers in TrackData), so after warming up nothing is allocated
+template <class TrackData>
+class AnimationPool {
+public:
+    struct StartedTrack {
+        AnimationTrackId Id;
+        // Might contain the data of a previously finished track, the caller has to overwrite all of it
+        TrackData& Data;
+    };
+
+    StartedTrack Start(double durationMs, EasingFunction easing)
+    {
+        if (_activeCount == _ids.size()) {
+            _ids.emplace_back();
+            _timePassed.emplace_back();
+            _durations.emplace_back();
+            _progress.emplace_back();
+            _previousProgress.emplace_back();
+            _easings.emplace_back();
+            _data.emplace_back();
+        }
+
+        auto index = _activeCount++;
+        _ids[index] = _nextId++;
+        _timePassed[index] = 0;
+        _durations[index] = durationMs;
+        _progress[index] = 0.0f;
+        _previousProgress[index] = 0.0f;
+        _easings[index] = easing;
+
+        return StartedTrack { _ids[index], _data[index] };
+    }
+
+    // Advances every active track. onFinished(AnimationTrackId, TrackData&) is called for the finished tracks after
+    // all the tracks were updated, so it can safely start new tracks
+    template <class OnFinished>
+    void Update(uint64_t deltaTimeMs, OnFinished&& onFinished)
+    {
+        size_t finishedCount = 0;
+
+        std::copy(_progress.begin(), _progress.begin() + _activeCount, _previousProgress.begin());
+
+        for (size_t i = 0; i < _activeCount;) {
+            _timePassed[i] += deltaTimeMs;
+            double rawProgress = _timePassed[i] / _durations[i];
+
+            if (rawProgress > 1.0) {
+                if (finishedCount == _finishedData.size()) {
+                    _finishedIds.emplace_back();
+                    _finishedData.emplace_back();
+                }
+
+                _finishedIds[finishedCount] = _ids[i];
+                std::swap(_finishedData[finishedCount], _data[i]);
+                ++finishedCount;
+
+                // Move the last active track here. It wasn't updated yet, so the index is not incremented
+                SwapTracks(i, --_activeCount);
+            } else {
+                _progress[i] = float(rawProgress);
+                ++i;
+            }
+        }
+
+        Easing::Evaluate(_easings.data(), _progress.data(), _progress.data(), _activeCount);
+
+        for (size_t i = 0; i < finishedCount; ++i) {
+            onFinished(_finishedIds[i], _finishedData[i]);
+        }
+    }
+
+    // visitor(const TrackData&, float easedProgress) is called for every active track. The progress is interpolated
+    // between the last 2 updates, an alpha of 0 gives the progress before the last update and 1 the current one
+    template <class Visitor>
+    void ForEach(Visitor&& visitor, float interpolationAlpha = 1.0f) const
+    {
+        for (size_t i = 0; i < _activeCount; ++i) {
+            visitor(_data[i], _previousProgress[i] + (_progress[i] - _previousProgress[i]) * interpolationAlpha);
+        }
+    }
+
+    size_t GetActiveTrackCount() const
+    {
+        return _activeCount;
+    }
+
+    void Clear()
+    {
+        _activeCount = 0;
+    }
+
+private:
+    std::vector<AnimationTrackId> _ids;
+    std::vector<uint64_t> _timePassed;
+    std::vector<double> _durations;
+    // The raw progress during the update, the eased one after it
+    std::vector<float> _progress;
+    // The eased progress before the last update
+    std::vector<float> _previousProgress;
+    std::vector<EasingFunction> _easings;
+    std::vector<TrackData> _data;
+    size_t _activeCount = 0;
+
+    // The data of the tracks that finished in the current update, swapped out of the pool
+    std::vector<AnimationTrackId> _finishedIds;
+    std::vector<TrackData> _finishedData;
+
+    AnimationTrackId _nextId = 1;
+
+    void SwapTracks(size_t lhs, size_t rhs)
+    {
+        assert(lhs <= rhs);
+        if (lhs == rhs) {
+            return;
+        }
+
+        std::swap(_ids[lhs], _ids[rhs]);
+        std::swap(_timePassed[lhs], _timePassed[rhs]);
+        std::swap(_durations[lhs], _durations[rhs]);
+        std::swap(_progress[lhs], _progress[rhs]);
+        std::swap(_previousProgress[lhs], _previousProgress[rhs]);
+        std::swap(_easings[lhs], _easings[rhs]);
+        std::swap(_data[lhs], _data[rhs]);
+    }
+};
@@ -0,0 +1,8 @@
+#include "AnimationSpeed.h"
+
+#include <algorithm>
+
+float AnimationSpeed::GetScale(AnimationCategory category) const
+{
+    return std::clamp(GlobalScale * CategoryScales[size_t(category)], MinScale, MaxScale);
+}
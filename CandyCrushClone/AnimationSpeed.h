@@ -0,0 +1,25 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+enum class AnimationCategory {
+    Switch,
+    Destroy,
+    Fall,
+    Particles,
+    Count,
+};
+
+// How fast the animations of the game world play, 2 means twice as fast. The global scale is multiplied by the scale of
+// the category. In instant mode a move is resolved in the same update that it was made in, only the particles still fly
+struct AnimationSpeed {
+    static constexpr float MinScale = 0.05f;
+    static constexpr float MaxScale = 20.0f;
+
+    float GlobalScale = 1.0f;
+    std::array<float, size_t(AnimationCategory::Count)> CategoryScales { 1.0f, 1.0f, 1.0f, 1.0f };
+    bool IsInstant = false;
+
+    float GetScale(AnimationCategory category) const;
+};
@@ -11,8 +11,8 @@ static constexpr const char* const BackgroundMusicFolder = "Assets/Sounds/Backgr
 static constexpr const char* const TileDisappearEffectPath = "./Assets/Sounds/disappear.mp3";
 }
 
-AudioPlayer::AudioPlayer()
-    : _randomEngine(_randomDevice())
+AudioPlayer::AudioPlayer(unsigned int randomSeed)
+    : _randomEngine(randomSeed)
 {
 }
 
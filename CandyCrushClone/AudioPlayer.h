@@ -10,7 +10,7 @@ class AudioPlayer {
 public:
     enum class SoundEffect { TileDisappear };
 
-    AudioPlayer();
+    explicit AudioPlayer(unsigned int randomSeed);
     ~AudioPlayer();
 
     bool Initialize();
@@ -23,7 +23,6 @@ private:
     std::vector<Mix_Music*> _backgroundTracks;
     int _lastPlayedMusicIndex = 0;
 
-    std::random_device _randomDevice;
     std::mt19937 _randomEngine;
     std::uniform_int_distribution<int> _randomDistribution;
 
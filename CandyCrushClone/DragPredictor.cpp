@@ -0,0 +1,83 @@
+#include "DragPredictor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+double Distance(Vec2 lhs, Vec2 rhs)
+{
+    return std::sqrt(double(lhs.DistanceSquared(rhs)));
+}
+}
+
+void DragPredictor::Reset()
+{
+    _sampleCount = 0;
+}
+
+void DragPredictor::AddSample(Vec2 position, uint32_t timestampMs)
+{
+    if (_sampleCount >= 2) {
+        // The prediction of the previous sample for this moment, compared to not predicting at all
+        const auto& last = GetSample(0);
+        auto predicted = last.Position + Predict(timestampMs - last.TimestampMs);
+
+        ++_stats.SampleCount;
+        _stats.PredictedErrorSum += Distance(position, predicted);
+        _stats.UnpredictedErrorSum += Distance(position, last.Position);
+    }
+
+    _lastSampleIndex = (_lastSampleIndex + 1) % MaxSampleCount;
+    _samples[_lastSampleIndex] = Sample { position, timestampMs };
+    _sampleCount = std::min(_sampleCount + 1, MaxSampleCount);
+}
+
+Vec2 DragPredictor::Predict(uint32_t lookaheadMs) const
+{
+    auto velocity = GetVelocity();
+    if (!velocity) {
+        return Vec2 { 0, 0 };
+    }
+
+    auto x = velocity->X * float(lookaheadMs);
+    auto y = velocity->Y * float(lookaheadMs);
+
+    auto length = std::sqrt(x * x + y * y);
+    if (length > MaxPredictionDistance) {
+        x *= MaxPredictionDistance / length;
+        y *= MaxPredictionDistance / length;
+    }
+
+    return Vec2 { int(std::lround(x)), int(std::lround(y)) };
+}
+
+std::optional<DragVelocity> DragPredictor::GetVelocity() const
+{
+    if (_sampleCount < 2) {
+        return std::nullopt;
+    }
+
+    const auto& last = GetSample(0);
+    const Sample* oldest = nullptr;
+    for (size_t age = 1; age < _sampleCount && last.TimestampMs - GetSample(age).TimestampMs <= VelocityWindowMs; ++age) {
+        oldest = &GetSample(age);
+    }
+
+    // The SDL timestamps are in milliseconds, samples closer than that don't give a velocity
+    if (!oldest || oldest->TimestampMs == last.TimestampMs) {
+        return std::nullopt;
+    }
+
+    auto elapsedMs = float(last.TimestampMs - oldest->TimestampMs);
+    return DragVelocity { float(last.Position.x - oldest->Position.x) / elapsedMs, float(last.Position.y - oldest->Position.y) / elapsedMs };
+}
+
+const DragPredictionStats& DragPredictor::GetStats() const
+{
+    return _stats;
+}
+
+const DragPredictor::Sample& DragPredictor::GetSample(size_t age) const
+{
+    return _samples[(_lastSampleIndex + MaxSampleCount - age) % MaxSampleCount];
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Vec2.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// How far the extrapolation of the previous samples was from the next sample, compared to staying at the previous one
+struct DragPredictionStats {
+    uint64_t SampleCount = 0;
+    double PredictedErrorSum = 0.0;
+    double UnpredictedErrorSum = 0.0;
+};
+
+// In pixels per millisecond
+struct DragVelocity {
+    float X;
+    float Y;
+};
+
+// Extrapolates the dragged cursor to the time the frame showing it is presented. The velocity is averaged over the
+// recent samples and the extrapolated distance is clamped, so a sudden stop or turn can only overshoot a little
+class DragPredictor {
+public:
+    void Reset();
+    void AddSample(Vec2 position, uint32_t timestampMs);
+    // The offset from the last sample to where the cursor is expected to be lookaheadMs after it
+    Vec2 Predict(uint32_t lookaheadMs) const;
+    // nullopt until there are samples far enough apart
+    std::optional<DragVelocity> GetVelocity() const;
+
+    const DragPredictionStats& GetStats() const;
+
+private:
+    struct Sample {
+        Vec2 Position;
+        uint32_t TimestampMs;
+    };
+
+    // Enough for the velocity window with the 1 ms pointer samples
+    static constexpr size_t MaxSampleCount = 64;
+    // Only the samples this close to the last one are used for the velocity, older ones don't describe the motion
+    static constexpr uint32_t VelocityWindowMs = 50;
+    static constexpr float MaxPredictionDistance = 20.0f;
+
+    std::array<Sample, MaxSampleCount> _samples {};
+    size_t _sampleCount = 0;
+    size_t _lastSampleIndex = 0;
+
+    DragPredictionStats _stats;
+
+    const Sample& GetSample(size_t age) const;
+};
@@ -0,0 +1,115 @@
+#include "DrawList.h"
+#include "Screen.h"
+
+#include <span>
+
+void DrawList::Clear()
+{
+    _commands.clear();
+    _textCount = 0;
+    _particleSprites.clear();
+}
+
+void DrawList::DrawCell(Vec2 coords, int cellType, int sourceSize, int destinationSize)
+{
+    auto& command = _commands.emplace_back(Command { CommandType::Cell });
+    command.Position = coords;
+    command.CellType = cellType;
+    command.SourceSize = sourceSize;
+    command.DestinationSize = destinationSize;
+}
+
+void DrawList::DrawDestroyAnimation(Vec2 coords, int size, double progress)
+{
+    auto& command = _commands.emplace_back(Command { CommandType::DestroyAnimation });
+    command.Position = coords;
+    command.DestinationSize = size;
+    command.Progress = progress;
+}
+
+void DrawList::DrawParticles(const ParticleSystem& particles)
+{
+    auto& command = _commands.emplace_back(Command { CommandType::Particles });
+    command.First = _particleSprites.size();
+
+    particles.ForEach([this](float x, float y, float size, SDL_Color color) {
+        _particleSprites.push_back(ParticleSprite { x, y, size, color });
+    });
+
+    command.Count = _particleSprites.size() - command.First;
+}
+
+void DrawList::DrawButton(const std::string& text, const SDL_Rect& coords, bool isHovered)
+{
+    auto& command = _commands.emplace_back(Command { CommandType::Button });
+    command.Rect = coords;
+    command.Flag = isHovered;
+    command.First = AddText(text);
+}
+
+void DrawList::DrawText(const std::string& text, const SDL_Rect& textRect, bool useLargeFont, SDL_Color color)
+{
+    auto& command = _commands.emplace_back(Command { CommandType::Text });
+    command.Rect = textRect;
+    command.Flag = useLargeFont;
+    command.Color = color;
+    command.First = AddText(text);
+}
+
+void DrawList::DrawBackgroundRectangle(const SDL_Rect& rect, SDL_Color color)
+{
+    auto& command = _commands.emplace_back(Command { CommandType::BackgroundRectangle });
+    command.Rect = rect;
+    command.Color = color;
+}
+
+void DrawList::Execute(Screen& screen) const
+{
+    for (const auto& command : _commands) {
+        switch (command.Type) {
+        case CommandType::Cell: {
+            screen.DrawCell(command.Position, command.CellType, command.SourceSize, command.DestinationSize);
+        } break;
+        case CommandType::DestroyAnimation: {
+            screen.DrawDestroyAnimation(command.Position, command.DestinationSize, command.Progress);
+        } break;
+        case CommandType::Particles: {
+            screen.DrawParticles(std::span<const ParticleSprite>(_particleSprites.data() + command.First, command.Count));
+        } break;
+        case CommandType::Button: {
+            screen.DrawButton(_texts[command.First], command.Rect, command.Flag);
+        } break;
+        case CommandType::Text: {
+            screen.DrawText(_texts[command.First], command.Rect, command.Flag, command.Color);
+        } break;
+        case CommandType::BackgroundRectangle: {
+            screen.DrawBackgroundRectangle(command.Rect, command.Color);
+        } break;
+        }
+    }
+}
+
+size_t DrawList::GetCommandCount() const
+{
+    return _commands.size();
+}
+
+void DrawList::SetFrameNumber(uint64_t frameNumber)
+{
+    _frameNumber = frameNumber;
+}
+
+uint64_t DrawList::GetFrameNumber() const
+{
+    return _frameNumber;
+}
+
+size_t DrawList::AddText(const std::string& text)
+{
+    if (_textCount == _texts.size()) {
+        _texts.emplace_back();
+    }
+
+    _texts[_textCount].assign(text);
+    return _textCount++;
+}
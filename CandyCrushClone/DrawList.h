@@ -0,0 +1,72 @@
+#pragma once
+
+#include "ParticleSystem.h"
+#include "Vec2.h"
+
+#include <SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Screen;
+
+// The draw calls of a frame, recorded with the same functions as the ones of the Screen, so they can be executed later,
+// even on another thread. Clearing keeps the capacity of every container, so after warming up nothing is allocated
+class DrawList {
+public:
+    void Clear();
+
+    void DrawCell(Vec2 coords, int cellType, int sourceSize, int destinationSize);
+    void DrawDestroyAnimation(Vec2 coords, int size, double progress);
+    // The live particles are copied, the system can be updated after this
+    void DrawParticles(const ParticleSystem& particles);
+    void DrawButton(const std::string& text, const SDL_Rect& coords, bool isHovered);
+    void DrawText(const std::string& text, const SDL_Rect& textRect, bool useLargeFont, SDL_Color color = { 255, 255, 255 });
+    void DrawBackgroundRectangle(const SDL_Rect& rect, SDL_Color color = { 50, 50, 50, 100 });
+
+    // Replays the recorded calls in order. Has to be called between Screen::BeginFrame and Screen::Present
+    void Execute(Screen& screen) const;
+
+    size_t GetCommandCount() const;
+
+    // The frames are numbered in the order they are recorded, the latency tracking uses it to find the presented frame
+    void SetFrameNumber(uint64_t frameNumber);
+    uint64_t GetFrameNumber() const;
+
+private:
+    enum class CommandType : uint8_t {
+        Cell,
+        DestroyAnimation,
+        Particles,
+        Button,
+        Text,
+        BackgroundRectangle,
+    };
+
+    struct Command {
+        CommandType Type;
+        Vec2 Position {};
+        SDL_Rect Rect {};
+        int CellType = 0;
+        int SourceSize = 0;
+        int DestinationSize = 0;
+        double Progress = 0.0;
+        SDL_Color Color {};
+        // IsHovered for the buttons, UseLargeFont for the texts
+        bool Flag = false;
+        // The text or the range of particles of the command
+        size_t First = 0;
+        size_t Count = 0;
+    };
+
+    std::vector<Command> _commands;
+    // Only the first _textCount strings belong to the frame, the rest are kept for their capacity
+    std::vector<std::string> _texts;
+    size_t _textCount = 0;
+    std::vector<ParticleSprite> _particleSprites;
+    uint64_t _frameNumber = 0;
+
+    size_t AddText(const std::string& text);
+};
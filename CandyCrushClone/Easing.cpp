@@ -0,0 +1,77 @@
+#include "Easing.h"
+
+#include <algorithm>
+
+namespace {
+static constexpr size_t TableStride = Easing::TableResolution + 1;
+static constexpr size_t FunctionCount = size_t(EasingFunction::Count);
+
+using EasingTable = std::array<float, FunctionCount * TableStride>;
+using SineTable = std::array<float, TableStride>;
+
+constexpr EasingTable MakeEasingTable()
+{
+    EasingTable table {};
+    for (size_t function = 0; function < FunctionCount; ++function) {
+        for (size_t i = 0; i < TableStride; ++i) {
+            table[function * TableStride + i] = float(Easing::EvaluateExact(EasingFunction(function), double(i) / Easing::TableResolution));
+        }
+    }
+
+    return table;
+}
+
+constexpr SineTable MakeSineTable()
+{
+    SineTable table {};
+    for (size_t i = 0; i < TableStride; ++i) {
+        table[i] = float(Easing::Sin(2 * Easing::Pi * double(i) / Easing::TableResolution));
+    }
+
+    return table;
+}
+
+static constexpr EasingTable EasingValues = MakeEasingTable();
+static constexpr SineTable SineValues = MakeSineTable();
+
+static_assert(EasingValues[size_t(EasingFunction::EaseOutBounce) * TableStride + Easing::TableResolution] == 1.0f);
+static_assert(SineValues[Easing::TableResolution / 4] > 0.9999f);
+
+float Interpolate(const float* table, float position)
+{
+    auto index = std::min(int(position), Easing::TableResolution - 1);
+    auto fraction = position - float(index);
+
+    return table[index] + (table[index + 1] - table[index]) * fraction;
+}
+}
+
+namespace Easing {
+float Evaluate(EasingFunction function, float progress)
+{
+    auto position = std::clamp(progress, 0.0f, 1.0f) * TableResolution;
+    return Interpolate(EasingValues.data() + size_t(function) * TableStride, position);
+}
+
+void Evaluate(const EasingFunction* functions, const float* progress, float* results, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        auto position = std::min(std::max(progress[i], 0.0f), 1.0f) * TableResolution;
+        auto index = std::min(int(position), TableResolution - 1);
+        auto fraction = position - float(index);
+        auto tableIndex = size_t(functions[i]) * TableStride + index;
+
+        results[i] = EasingValues[tableIndex] + (EasingValues[tableIndex + 1] - EasingValues[tableIndex]) * fraction;
+    }
+}
+
+float SinTurns(float turns)
+{
+    auto fraction = turns - float(int64_t(turns));
+    if (fraction < 0) {
+        fraction += 1.0f;
+    }
+
+    return Interpolate(SineValues.data(), fraction * TableResolution);
+}
+}
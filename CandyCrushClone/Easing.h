@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class EasingFunction : uint8_t {
+    Linear,
+    EaseInQuad,
+    EaseOutQuad,
+    EaseInCubic,
+    EaseOutCubic,
+    EaseInOutCubic,
+    EaseInOutSine,
+    EaseOutBack,
+    EaseOutBounce,
+    Count,
+};
+
+// Easing functions (see https://easings.net) evaluated from lookup tables that are generated at compile time.
+// Between the table entries the values are interpolated linearly. The error is below 0.0001, except around the
+// bounces of EaseOutBounce where it is below 0.003 (about a pixel over the longest fall of the cells)
+namespace Easing {
+static constexpr double Pi = 3.14159265358979323846;
+static constexpr int TableResolution = 512;
+
+// sin for constant expressions, accurate to about 1e-11
+constexpr double Sin(double x)
+{
+    // Reduce to [-pi, pi], then to [-pi/2, pi/2] where the Taylor series converges quickly
+    auto periods = x / (2 * Pi);
+    x -= 2 * Pi * double(int64_t(periods + (periods < 0 ? -0.5 : 0.5)));
+    if (x > Pi / 2) {
+        x = Pi - x;
+    } else if (x < -Pi / 2) {
+        x = -Pi - x;
+    }
+
+    auto x2 = x * x;
+    double result = 1.0;
+    for (int i = 15; i > 1; i -= 2) {
+        result = 1.0 - result * x2 / (i * (i - 1));
+    }
+
+    return x * result;
+}
+
+// The exact value of the easing function, used to generate the tables
+constexpr double EvaluateExact(EasingFunction function, double x)
+{
+    switch (function) {
+    case EasingFunction::Linear:
+        return x;
+    case EasingFunction::EaseInQuad:
+        return x * x;
+    case EasingFunction::EaseOutQuad:
+        return 1 - (1 - x) * (1 - x);
+    case EasingFunction::EaseInCubic:
+        return x * x * x;
+    case EasingFunction::EaseOutCubic:
+        return 1 - (1 - x) * (1 - x) * (1 - x);
+    case EasingFunction::EaseInOutCubic:
+        return x < 0.5 ? 4 * x * x * x : 1 - (2 - 2 * x) * (2 - 2 * x) * (2 - 2 * x) / 2;
+    case EasingFunction::EaseInOutSine:
+        return (1 - Sin(Pi * x + Pi / 2)) / 2;
+    case EasingFunction::EaseOutBack: {
+        constexpr double c1 = 1.70158;
+        constexpr double c3 = c1 + 1;
+        return 1 + c3 * (x - 1) * (x - 1) * (x - 1) + c1 * (x - 1) * (x - 1);
+    }
+    case EasingFunction::EaseOutBounce: {
+        constexpr double n1 = 7.5625;
+        constexpr double d1 = 2.75;
+
+        if (x < 1 / d1) {
+            return n1 * x * x;
+        } else if (x < 2 / d1) {
+            x -= 1.5 / d1;
+            return n1 * x * x + 0.75;
+        } else if (x < 2.5 / d1) {
+            x -= 2.25 / d1;
+            return n1 * x * x + 0.9375;
+        } else {
+            x -= 2.625 / d1;
+            return n1 * x * x + 0.984375;
+        }
+    }
+    case EasingFunction::Count:
+        break;
+    }
+
+    return x;
+}
+
+// progress is clamped to [0, 1]
+float Evaluate(EasingFunction function, float progress);
+// Evaluates every element with its own function. The loop has no branches, so it can be vectorized.
+// results can be the same array as progress
+void Evaluate(const EasingFunction* functions, const float* progress, float* results, size_t count);
+
+// sin(2 * pi * turns) from a lookup table. Useful for periodic animations, where turns is the elapsed time / period
+float SinTurns(float turns);
+}
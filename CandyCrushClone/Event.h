@@ -1,51 +1,226 @@
 #pragma once
 
+#include "InlineFunction.h"
+
 #include <cassert>
-#include <functional>
-#include <memory>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
+class EventSource {
+public:
+    // Does nothing if the subscription was already removed, the generation tells if the slot was reused since then
+    virtual void Unsubscribe(uint32_t slot, uint32_t generation) = 0;
+
+protected:
+    ~EventSource() = default;
+};
+
+// Unsubscribes when destroyed or reset. Can be moved, the moved-from token does nothing. The event has to outlive it
 class EventToken {
 public:
-    explicit EventToken(std::function<void()> unsubAction)
-        : _unsubAction(std::move(unsubAction))
+    EventToken() = default;
+
+    EventToken(EventSource& source, uint32_t slot, uint32_t generation)
+        : _source(&source)
+        , _slot(slot)
+        , _generation(generation)
+    {
+    }
+
+    EventToken(EventToken&& other) noexcept
+        : _source(std::exchange(other._source, nullptr))
+        , _slot(other._slot)
+        , _generation(other._generation)
+    {
+    }
+
+    EventToken& operator=(EventToken&& other) noexcept
+    {
+        if (this != &other) {
+            Reset();
+            _source = std::exchange(other._source, nullptr);
+            _slot = other._slot;
+            _generation = other._generation;
+        }
+
+        return *this;
+    }
+
+    EventToken(const EventToken&) = delete;
+    EventToken& operator=(const EventToken&) = delete;
+
+    ~EventToken()
     {
-        assert(_unsubAction);
+        Reset();
+    }
+
+    void Reset()
+    {
+        if (auto* source = std::exchange(_source, nullptr)) {
+            source->Unsubscribe(_slot, _generation);
+        }
     }
-    ~EventToken() { _unsubAction(); }
 
 private:
-    std::function<void()> _unsubAction;
+    EventSource* _source = nullptr;
+    uint32_t _slot = 0;
+    uint32_t _generation = 0;
 };
 
-template <class T>
-class Event {
+template <class Signature>
+class Event;
+
+// The subscribers are kept in a dense array and removed by swapping the last one into their place, so Invoke never
+// skips empty entries. The tokens refer to a slot that knows where the subscriber is in the dense array, and the slot's
+// generation changes when the subscriber is removed, so a stale token can't remove another subscriber.
+// Subscribing and unsubscribing from a callback is safe, these changes are applied when the outermost Invoke returns.
+// Nothing is allocated after the arrays reached the highest number of subscribers
+template <class... Args>
+class Event<void(Args...)> : private EventSource {
 public:
-    [[nodiscard]] std::unique_ptr<EventToken> Subscribe(T&& action)
+    using Callback = InlineFunction<void(Args...)>;
+
+    Event() = default;
+    // The tokens point to the event, so it can't be copied or moved
+    Event(const Event&) = delete;
+    Event& operator=(const Event&) = delete;
+
+    template <class F>
+    [[nodiscard]] EventToken Subscribe(F&& action)
     {
-        auto initialSize = _subscribers.size();
+        Callback callback { std::forward<F>(action) };
+        assert(callback);
 
-        for (int i = 0; i < initialSize; ++i) {
-            if (!_subscribers[i]) {
-                _subscribers[i] = std::move(action);
+        auto slot = AllocateSlot();
+        auto& subscribers = _invokeDepth > 0 ? _addedDuringInvoke : _subscribers;
+        _slots[slot].Index = uint32_t(subscribers.size()) | (_invokeDepth > 0 ? AddedDuringInvokeBit : 0);
+        subscribers.push_back(Subscriber { std::move(callback), slot });
+
+        return EventToken { *this, slot, _slots[slot].Generation };
+    }
 
-                return std::make_unique<EventToken>([this, i]() { _subscribers[i] = nullptr; });
+    template <class... Params>
+    void Invoke(const Params&... params)
+    {
+        ++_invokeDepth;
+
+        // The array can't change while it is iterated, the new subscribers are added to a separate one and the removed
+        // ones are only cleared, so its size and address can be kept in locals
+        auto* subscribers = _subscribers.data();
+        auto subscriberCount = _subscribers.size();
+        for (size_t i = 0; i < subscriberCount; ++i) {
+            if (subscribers[i].Action) {
+                subscribers[i].Action(params...);
             }
         }
 
-        _subscribers.push_back(std::move(action));
-        return std::make_unique<EventToken>([this, initialSize]() { _subscribers[initialSize] = nullptr; });
+        if (--_invokeDepth == 0) {
+            ApplyChangesFromInvoke();
+        }
     }
 
-    template <class... Params>
-    void Invoke(Params&&... params)
+    size_t GetSubscriberCount() const
     {
-        for (const auto& subscriber : _subscribers) {
-            if (subscriber)
-                subscriber(std::forward<Params>(params)...);
-        }
+        return _subscribers.size() + _addedDuringInvoke.size();
     }
 
 private:
-    std::vector<T> _subscribers;
-};
\ No newline at end of file
+    static constexpr uint32_t NoSlot = UINT32_MAX;
+    static constexpr uint32_t AddedDuringInvokeBit = 0x80000000;
+
+    struct Subscriber {
+        Callback Action;
+        uint32_t Slot;
+    };
+
+    struct Slot {
+        // The index of the subscriber while the slot is used, the next free slot otherwise
+        uint32_t Index = NoSlot;
+        uint32_t Generation = 0;
+    };
+
+    std::vector<Subscriber> _subscribers;
+    std::vector<Slot> _slots;
+    uint32_t _firstFreeSlot = NoSlot;
+
+    int _invokeDepth = 0;
+    bool _hasRemovedDuringInvoke = false;
+    std::vector<Subscriber> _addedDuringInvoke;
+
+    void Unsubscribe(uint32_t slot, uint32_t generation) override
+    {
+        if (slot >= _slots.size() || _slots[slot].Generation != generation) {
+            return;
+        }
+
+        // Every token of this slot is stale from now on
+        ++_slots[slot].Generation;
+
+        auto index = _slots[slot].Index;
+        if (index & AddedDuringInvokeBit) {
+            _addedDuringInvoke[index & ~AddedDuringInvokeBit].Action = nullptr;
+        } else if (_invokeDepth > 0) {
+            _subscribers[index].Action = nullptr;
+            _hasRemovedDuringInvoke = true;
+        } else {
+            RemoveSubscriber(index);
+        }
+    }
+
+    uint32_t AllocateSlot()
+    {
+        if (_firstFreeSlot == NoSlot) {
+            _slots.emplace_back();
+            return uint32_t(_slots.size() - 1);
+        }
+
+        auto slot = _firstFreeSlot;
+        _firstFreeSlot = _slots[slot].Index;
+        return slot;
+    }
+
+    void FreeSlot(uint32_t slot)
+    {
+        _slots[slot].Index = _firstFreeSlot;
+        _firstFreeSlot = slot;
+    }
+
+    void RemoveSubscriber(uint32_t index)
+    {
+        FreeSlot(_subscribers[index].Slot);
+
+        if (index + 1 != _subscribers.size()) {
+            _subscribers[index] = std::move(_subscribers.back());
+            _slots[_subscribers[index].Slot].Index = index;
+        }
+
+        _subscribers.pop_back();
+    }
+
+    void ApplyChangesFromInvoke()
+    {
+        if (_hasRemovedDuringInvoke) {
+            _hasRemovedDuringInvoke = false;
+
+            for (uint32_t i = 0; i < _subscribers.size();) {
+                if (_subscribers[i].Action) {
+                    ++i;
+                } else {
+                    RemoveSubscriber(i);
+                }
+            }
+        }
+
+        for (auto& subscriber : _addedDuringInvoke) {
+            if (subscriber.Action) {
+                _slots[subscriber.Slot].Index = uint32_t(_subscribers.size());
+                _subscribers.push_back(std::move(subscriber));
+            } else {
+                FreeSlot(subscriber.Slot);
+            }
+        }
+
+        _addedDuringInvoke.clear();
+    }
+};
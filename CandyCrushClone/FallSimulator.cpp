@@ -0,0 +1,166 @@
+#include "FallSimulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+template <class T>
+void ApplyOrder(std::vector<T>& values, const std::vector<uint32_t>& order)
+{
+    std::vector<T> orderedValues;
+    orderedValues.reserve(values.size());
+
+    for (auto index : order) {
+        orderedValues.push_back(values[index]);
+    }
+
+    values = std::move(orderedValues);
+}
+
+template <class T>
+void RemoveMarked(std::vector<T>& values, const std::vector<uint8_t>& isRemoved)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (!isRemoved[i]) {
+            values[kept++] = values[i];
+        }
+    }
+
+    values.resize(kept);
+}
+}
+
+FallSimulator::FallSimulator(int tileSize)
+    : _tileSize(tileSize)
+{
+}
+
+void FallSimulator::Add(int column, int startRow, int targetRow, int cellType)
+{
+    _columns.push_back(column);
+    _targetRows.push_back(targetRow);
+    _cellTypes.push_back(cellType);
+    _positions.push_back(float(startRow * _tileSize));
+    _previousPositions.push_back(float(startRow * _tileSize));
+    _velocities.push_back(0.0f);
+    _targetPositions.push_back(float(targetRow * _tileSize));
+    _isResting.push_back(0);
+
+    _isSorted = false;
+}
+
+const std::vector<Vec2>& FallSimulator::Update(float deltaTimeMs)
+{
+    _landedTiles.clear();
+
+    if (!_isSorted) {
+        Sort();
+    }
+
+    _previousPositions.assign(_positions.begin(), _positions.end());
+
+    while (deltaTimeMs > 0.0f && !_positions.empty()) {
+        auto stepMs = std::min(deltaTimeMs, MaxStepMs);
+        deltaTimeMs -= stepMs;
+
+        Step(stepMs);
+        RemoveRestingTiles();
+    }
+
+    return _landedTiles;
+}
+
+void FallSimulator::Clear()
+{
+    _columns.clear();
+    _targetRows.clear();
+    _cellTypes.clear();
+    _positions.clear();
+    _previousPositions.clear();
+    _velocities.clear();
+    _targetPositions.clear();
+    _isResting.clear();
+    _isSorted = true;
+}
+
+size_t FallSimulator::GetFallingTileCount() const
+{
+    return _positions.size();
+}
+
+void FallSimulator::Sort()
+{
+    // By column, then from the bottom of the column to the top
+    _sortOrder.resize(_positions.size());
+    std::iota(_sortOrder.begin(), _sortOrder.end(), 0);
+    std::sort(_sortOrder.begin(), _sortOrder.end(), [this](uint32_t lhs, uint32_t rhs) {
+        return _columns[lhs] != _columns[rhs] ? _columns[lhs] < _columns[rhs] : _targetRows[lhs] > _targetRows[rhs];
+    });
+
+    ApplyOrder(_columns, _sortOrder);
+    ApplyOrder(_targetRows, _sortOrder);
+    ApplyOrder(_cellTypes, _sortOrder);
+    ApplyOrder(_positions, _sortOrder);
+    ApplyOrder(_previousPositions, _sortOrder);
+    ApplyOrder(_velocities, _sortOrder);
+    ApplyOrder(_targetPositions, _sortOrder);
+    ApplyOrder(_isResting, _sortOrder);
+
+    _isSorted = true;
+}
+
+void FallSimulator::Step(float deltaTimeMs)
+{
+    auto count = _positions.size();
+    auto* positions = _positions.data();
+    auto* velocities = _velocities.data();
+    const auto* targetPositions = _targetPositions.data();
+
+    // Semi-implicit Euler integration
+    for (size_t i = 0; i < count; ++i) {
+        velocities[i] += Gravity * deltaTimeMs;
+        positions[i] += velocities[i] * deltaTimeMs;
+    }
+
+    // Bounce on the target position, it is the top of the tile below once that has landed
+    for (size_t i = 0; i < count; ++i) {
+        auto hasReachedTarget = positions[i] >= targetPositions[i];
+        positions[i] = hasReachedTarget ? targetPositions[i] : positions[i];
+        velocities[i] = hasReachedTarget && velocities[i] > 0.0f ? -velocities[i] * Restitution : velocities[i];
+    }
+
+    // Stack the tiles of the same column. The tile below is handled first, so the corrections propagate upwards
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0 && _columns[i - 1] == _columns[i] && positions[i] > positions[i - 1] - _tileSize) {
+            positions[i] = positions[i - 1] - _tileSize;
+            velocities[i] = std::min(velocities[i], velocities[i - 1]);
+        }
+
+        _isResting[i] = positions[i] >= targetPositions[i] && std::abs(velocities[i]) < RestVelocity;
+    }
+}
+
+void FallSimulator::RemoveRestingTiles()
+{
+    auto restingCount = std::count(_isResting.begin(), _isResting.end(), uint8_t(1));
+    if (restingCount == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < _isResting.size(); ++i) {
+        if (_isResting[i]) {
+            _landedTiles.push_back(Vec2 { _columns[i], _targetRows[i] });
+        }
+    }
+
+    RemoveMarked(_columns, _isResting);
+    RemoveMarked(_targetRows, _isResting);
+    RemoveMarked(_cellTypes, _isResting);
+    RemoveMarked(_positions, _isResting);
+    RemoveMarked(_previousPositions, _isResting);
+    RemoveMarked(_velocities, _isResting);
+    RemoveMarked(_targetPositions, _isResting);
+    _isResting.assign(_positions.size(), 0);
+}
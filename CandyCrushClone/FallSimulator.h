@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Vec2.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Simulates tiles falling into their place in the columns of the board, with gravity, bounces and collisions between
+// the tiles of the same column, so every tile falls as long as its height requires.
+// The state of the tiles is kept in parallel arrays. The integration loops have no branches, so the compiler can
+// vectorize them, and the arrays are sorted by column and target row, so the tile below is always the previous one
+class FallSimulator {
+public:
+    explicit FallSimulator(int tileSize);
+
+    // The tile falls from startRow (negative rows are above the board) to targetRow of the column
+    void Add(int column, int startRow, int targetRow, int cellType);
+    // Returns the board indices of the tiles that came to rest, they are removed from the simulation
+    const std::vector<Vec2>& Update(float deltaTimeMs);
+    void Clear();
+
+    // visitor(Vec2 position, int cellType) is called for every falling tile. The position is interpolated between the
+    // last 2 updates, an alpha of 0 gives the position before the last update and 1 the current one
+    template <class Visitor>
+    void ForEach(Visitor&& visitor, float interpolationAlpha = 1.0f) const
+    {
+        for (size_t i = 0; i < _positions.size(); ++i) {
+            auto position = _previousPositions[i] + (_positions[i] - _previousPositions[i]) * interpolationAlpha;
+            visitor(Vec2 { _columns[i] * _tileSize, int(position) }, _cellTypes[i]);
+        }
+    }
+
+    size_t GetFallingTileCount() const;
+
+private:
+    static constexpr float Gravity = 0.004f; // Pixels / ms^2
+    static constexpr float Restitution = 0.3f; // The fraction of the velocity kept after a bounce
+    static constexpr float RestVelocity = 0.1f; // Pixels / ms, a bounce slower than this ends the fall
+    static constexpr float MaxStepMs = 4.0f; // Longer updates are split, so the tiles can't pass through each other
+
+    int _tileSize;
+
+    std::vector<int> _columns;
+    std::vector<int> _targetRows;
+    std::vector<int> _cellTypes;
+    std::vector<float> _positions;
+    // The positions before the last update
+    std::vector<float> _previousPositions;
+    std::vector<float> _velocities;
+    std::vector<float> _targetPositions;
+    std::vector<uint8_t> _isResting;
+
+    bool _isSorted = true;
+    std::vector<uint32_t> _sortOrder;
+    std::vector<Vec2> _landedTiles;
+
+    void Sort();
+    void Step(float deltaTimeMs);
+    void RemoveRestingTiles();
+};
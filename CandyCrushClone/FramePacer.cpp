@@ -0,0 +1,143 @@
+#include "FramePacer.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+void FrameTimeHistogram::Add(double frameTimeMs)
+{
+    auto bucket = std::min(size_t(std::max(frameTimeMs, 0.0) / BucketWidthMs), BucketCount - 1);
+    ++_buckets[bucket];
+
+    ++_count;
+    _sum += frameTimeMs;
+    _sumOfSquares += frameTimeMs * frameTimeMs;
+    _max = std::max(_max, frameTimeMs);
+}
+
+void FrameTimeHistogram::Clear()
+{
+    *this = FrameTimeHistogram {};
+}
+
+double FrameTimeHistogram::GetPercentile(double percentile) const
+{
+    if (_count == 0) {
+        return 0.0;
+    }
+
+    auto rank = uint64_t(std::ceil(percentile / 100.0 * _count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BucketCount; ++i) {
+        seen += _buckets[i];
+        if (seen >= std::max(rank, uint64_t(1))) {
+            return (i + 1) * BucketWidthMs;
+        }
+    }
+
+    return _max;
+}
+
+double FrameTimeHistogram::GetMean() const
+{
+    return _count == 0 ? 0.0 : _sum / _count;
+}
+
+double FrameTimeHistogram::GetStandardDeviation() const
+{
+    if (_count == 0) {
+        return 0.0;
+    }
+
+    auto mean = GetMean();
+    return std::sqrt(std::max(_sumOfSquares / _count - mean * mean, 0.0));
+}
+
+double FrameTimeHistogram::GetMax() const
+{
+    return _max;
+}
+
+uint64_t FrameTimeHistogram::GetCount() const
+{
+    return _count;
+}
+
+uint32_t FrameTimeHistogram::GetBucketCount(size_t bucket) const
+{
+    return _buckets[bucket];
+}
+
+void FrameTimeHistogram::Print(std::ostream& stream) const
+{
+    stream << "Frames: " << _count << ", mean: " << GetMean() << " ms, standard deviation: " << GetStandardDeviation() << " ms" << std::endl;
+    stream << "p50: " << GetPercentile(50) << " ms, p95: " << GetPercentile(95) << " ms, p99: " << GetPercentile(99) << " ms, max: " << _max << " ms" << std::endl;
+}
+
+FramePacer::FramePacer(int targetFps, bool isVsyncEnabled, WaitMode waitMode)
+    : _frequency(SDL_GetPerformanceFrequency())
+    , _framePeriod(_frequency / uint64_t(std::max(targetFps, 1)))
+    , _deadline(SDL_GetPerformanceCounter() + _framePeriod)
+    , _previousFrameEnd(SDL_GetPerformanceCounter())
+    , _isVsyncEnabled(isVsyncEnabled)
+    , _waitMode(waitMode)
+{
+}
+
+void FramePacer::WaitForNextFrame()
+{
+    auto now = SDL_GetPerformanceCounter();
+
+    if (!_isVsyncEnabled) {
+        if (now < _deadline && _waitMode == WaitMode::SleepOnly) {
+            SDL_Delay(uint32_t(std::ceil(ToMilliseconds(_deadline - now))));
+            now = SDL_GetPerformanceCounter();
+        } else if (now < _deadline) {
+            auto remainingMs = ToMilliseconds(_deadline - now);
+            if (remainingMs > SpinThresholdMs) {
+                SDL_Delay(uint32_t(remainingMs - SpinThresholdMs));
+            }
+
+            while ((now = SDL_GetPerformanceCounter()) < _deadline) {
+                std::this_thread::yield();
+            }
+        }
+
+        // If the frame was late by more than a whole period, don't rush the next frames to catch up
+        _deadline += _framePeriod;
+        if (_deadline <= now) {
+            _deadline = now + _framePeriod;
+        }
+    }
+
+    if (_hasPreviousFrame) {
+        _histogram.Add(ToMilliseconds(now - _previousFrameEnd));
+    }
+
+    _previousFrameEnd = now;
+    _hasPreviousFrame = true;
+}
+
+void FramePacer::Restart()
+{
+    _previousFrameEnd = SDL_GetPerformanceCounter();
+    _deadline = _previousFrameEnd + _framePeriod;
+    _hasPreviousFrame = false;
+}
+
+uint32_t FramePacer::GetFramePeriodMs() const
+{
+    return uint32_t(ToMilliseconds(_framePeriod));
+}
+
+const FrameTimeHistogram& FramePacer::GetHistogram() const
+{
+    return _histogram;
+}
+
+double FramePacer::ToMilliseconds(uint64_t counterDifference) const
+{
+    return double(counterDifference) * 1000.0 / double(_frequency);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Counts the frame times (or other durations, eg. the input latencies) in fixed width buckets, so the percentiles can be
+// read without storing every sample
+class FrameTimeHistogram {
+public:
+    static constexpr double BucketWidthMs = 0.1;
+    static constexpr size_t BucketCount = 1000; // The last bucket also collects the frames longer than 100 ms
+
+    void Add(double frameTimeMs);
+    void Clear();
+
+    // Returns the upper edge of the bucket that contains the given percentile, in the range [0, 100]
+    double GetPercentile(double percentile) const;
+    double GetMean() const;
+    double GetStandardDeviation() const;
+    double GetMax() const;
+    uint64_t GetCount() const;
+    uint32_t GetBucketCount(size_t bucket) const;
+
+    void Print(std::ostream& stream) const;
+
+private:
+    std::array<uint32_t, BucketCount> _buckets {};
+    uint64_t _count = 0;
+    double _sum = 0.0;
+    double _sumOfSquares = 0.0;
+    double _max = 0.0;
+};
+
+// Keeps the frames at a steady rate. Every frame has a deadline on the high resolution counter, and the next deadline
+// is always one period after the previous one, so the rate doesn't drift. Most of the wait is slept, but SDL_Delay can
+// oversleep by a millisecond or more, so the last part is spun.
+// With vsync Present already waits for the display, so the pacer only measures the frames
+class FramePacer {
+public:
+    enum class WaitMode {
+        SleepAndSpin,
+        // For the threads that don't present, a frame can be a millisecond late but the thread doesn't spin
+        SleepOnly,
+    };
+
+    FramePacer(int targetFps, bool isVsyncEnabled, WaitMode waitMode = WaitMode::SleepAndSpin);
+
+    // Waits until the deadline of the current frame and records the time since the previous frame
+    void WaitForNextFrame();
+    // Call when the loop waited for something else (eg. for events). The next frame starts now and isn't recorded
+    void Restart();
+
+    uint32_t GetFramePeriodMs() const;
+    const FrameTimeHistogram& GetHistogram() const;
+
+private:
+    static constexpr double SpinThresholdMs = 2.0;
+
+    uint64_t _frequency;
+    uint64_t _framePeriod;
+    uint64_t _deadline;
+    uint64_t _previousFrameEnd;
+    bool _hasPreviousFrame = false;
+    bool _isVsyncEnabled;
+    WaitMode _waitMode;
+
+    FrameTimeHistogram _histogram;
+
+    double ToMilliseconds(uint64_t counterDifference) const;
+};
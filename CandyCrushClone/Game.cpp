@@ -3,12 +3,17 @@
 #include "GameState.h"
 #include "InputProcessor.h"
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <random>
+#include <thread>
+#include <utility>
 
-Game::Game()
-    : _screen(Screen::GetScreen())
+Game::Game(const GameOptions& options)
+    : _screen(Screen::GetScreen(options.IsHeadless ? Screen::Mode::Offscreen : Screen::Mode::Windowed))
     , _inputProcessor(std::make_unique<InputProcessor>())
     , _highScore(std::make_unique<HighScore>())
 {
@@ -17,13 +22,42 @@ Game::Game()
         std::terminate();
     }
 
-    _audioPlayer = std::make_unique<AudioPlayer>();
-    _gameWorld = std::make_unique<GameWorld>(8, 8, 5, *_screen, *_audioPlayer);
+    _screen->SetSoftwareBlitterEnabled(options.UseSoftwareBlitter, options.SoftwareBlitterThreadCount);
+
+    auto isVsyncEnabled = options.UseVsync && !options.IsHeadless && _screen->SetVsyncEnabled(true);
+    _framePacer = std::make_unique<FramePacer>(options.TargetFps, isVsyncEnabled);
+    _latencyTracker = std::make_unique<LatencyTracker>();
+    if (auto windowPosition = _screen->GetWindowPosition(); options.UsePointerSampling && windowPosition) {
+        _pointerSampler = std::make_unique<PointerSampler>(*windowPosition);
+    }
+    _printFrameStatistics = options.PrintFrameStatistics;
+    _useSimulationThread = options.UseSimulationThread;
+    _targetFps = options.TargetFps;
+    _showLatencyOverlay = options.ShowLatencyOverlay;
+    _latencyHistogramFilePath = options.LatencyHistogramFilePath;
+
+    auto seeds = options.Seeds.value_or(RandomSeeds { std::random_device {}(), std::random_device {}() });
+    if (options.InputRecordingFilePath) {
+        // The game can be played without recording, so we don't terminate here
+        _inputRecorder = InputRecorder::Create(*options.InputRecordingFilePath, seeds, options.Speed);
+    }
+
+    if (options.SoakMinutes) {
+        _soakBot = std::make_unique<SoakBot>(uint64_t(*options.SoakMinutes) * 60 * 1000, seeds.World);
+    }
+
+    _audioPlayer = std::make_unique<AudioPlayer>(seeds.Audio);
+    _gameWorld = std::make_unique<GameWorld>(8, 8, 5, *_screen, *_audioPlayer, seeds.World);
     _menu = std::make_unique<MainMenu>(*_screen, *_inputProcessor);
     _player = std::make_unique<Player>(*_inputProcessor, *_gameWorld);
 
+    _gameWorld->SetAnimationSpeed(options.Speed);
+    // A drag event waits for the next frame in the queue, and that frame is presented about a frame period later
+    _player->SetDragPrediction(options.UseDragPrediction, _framePacer->GetFramePeriodMs());
+    _player->SetFlickSwitchEnabled(options.UseFlickSwitches);
+
     // This is not strictly necessary, the game can be played without sound as well, so we don't terminate here
-    if (!_audioPlayer->Initialize()) {
+    if (!options.IsHeadless && !_audioPlayer->Initialize()) {
         std::cerr << "Failed to initialize SDL Mixer" << std::endl;
     }
 
@@ -36,6 +70,129 @@ Game::Game()
 }
 
 void Game::RunMainLoop()
+{
+    if (_useSimulationThread) {
+        RunThreadedLoop();
+    } else {
+        RunSingleThreadedLoop();
+    }
+
+    if (_highScoreWriter.joinable()) {
+        _highScoreWriter.join();
+    }
+
+    _highScore->WriteHighScore();
+
+    if (_printFrameStatistics) {
+        _framePacer->GetHistogram().Print(std::cout);
+
+        const auto& inputStats = _inputProcessor->GetMaxDispatchStats();
+        std::cout << "Input events in a frame at most: " << inputStats.ReceivedEventCount << " received, " << inputStats.DispatchedEventCount
+                  << " dispatched after coalescing, " << inputStats.HandlerCallCount << " handler calls" << std::endl;
+
+        _latencyTracker->PrintSummary(std::cout);
+
+        PrintDragStatistics();
+    }
+
+    if (_latencyHistogramFilePath) {
+        _latencyTracker->WriteHistograms(*_latencyHistogramFilePath);
+    }
+
+    if (_soakBot) {
+        _soakBot->PrintSummary(std::cout);
+    }
+}
+
+void Game::RunReplay(const InputReplay& replay)
+{
+    _isReplaying = true;
+
+    auto frequency = double(SDL_GetPerformanceFrequency());
+    auto toMilliseconds = [frequency](uint64_t counterDifference) { return double(counterDifference) * 1000.0 / frequency; };
+
+    FrameTimeHistogram updateTimes;
+    FrameTimeHistogram drawTimes;
+    size_t replayedFrameCount = 0;
+    uint64_t replayedMs = 0;
+
+    // The whole cursor path is known, so the drawn drag can be matched to the time the cursor was there
+    std::vector<PositionSample> cursorPath;
+    for (const auto& frame : replay.GetFrames()) {
+        for (const auto& e : frame.Events) {
+            if (e.type == SDL_MOUSEMOTION) {
+                cursorPath.push_back(PositionSample { Vec2 { e.motion.x, e.motion.y }, e.motion.timestamp });
+            } else if (e.type == SDL_MOUSEBUTTONDOWN) {
+                cursorPath.push_back(PositionSample { Vec2 { e.button.x, e.button.y }, e.button.timestamp });
+            }
+        }
+    }
+
+    auto start = SDL_GetPerformanceCounter();
+
+    for (const auto& frame : replay.GetFrames()) {
+        if (_shouldQuit) {
+            break;
+        }
+
+        auto updateStart = SDL_GetPerformanceCounter();
+        // The event timestamps of the replay are on this clock
+        replayedMs += frame.DeltaTimeMs;
+
+        bool needsRedraw = false;
+        for (const auto& e : frame.Events) {
+            needsRedraw = HandleEvent(e) || needsRedraw;
+        }
+
+        _inputProcessor->DispatchQueuedEvents();
+        auto isRecorded = UpdateAndRecordFrame(frame.DeltaTimeMs, needsRedraw, _drawList);
+
+        auto drawStart = SDL_GetPerformanceCounter();
+        updateTimes.Add(toMilliseconds(drawStart - updateStart));
+
+        if (isRecorded) {
+            _screen->BeginFrame();
+            _drawList.Execute(*_screen);
+            _screen->Present();
+
+            drawTimes.Add(toMilliseconds(SDL_GetPerformanceCounter() - drawStart));
+
+            // The frame is taken to be presented a frame period after the update, like the drag prediction expects
+            if (auto drawnPosition = _player->GetDrawnDragPosition()) {
+                auto presentMs = uint32_t(replayedMs + _framePacer->GetFramePeriodMs());
+                _latencyTracker->AddDrawnDragLag(cursorPath, *drawnPosition, _player->GetDragStartTimestamp(), uint32_t(replayedMs), presentMs);
+            }
+        }
+
+        ++replayedFrameCount;
+    }
+
+    auto elapsedMs = toMilliseconds(SDL_GetPerformanceCounter() - start);
+    std::cout << "Replayed " << replayedFrameCount << " updates and " << replay.GetEventCount() << " events in " << elapsedMs << " ms, "
+              << drawTimes.GetCount() << " frames were drawn" << std::endl;
+    std::cout << "Updates:" << std::endl;
+    updateTimes.Print(std::cout);
+    std::cout << "Draws:" << std::endl;
+    drawTimes.Print(std::cout);
+
+    _latencyTracker->PrintSummary(std::cout);
+    PrintDragStatistics();
+}
+
+void Game::PrintDragStatistics() const
+{
+    if (const auto& stats = _player->GetDragPredictionStats(); stats.SampleCount != 0) {
+        std::cout << "Drag samples: " << stats.SampleCount << ", mean distance from the next sample: " << stats.PredictedErrorSum / stats.SampleCount
+                  << " px extrapolated, " << stats.UnpredictedErrorSum / stats.SampleCount << " px without extrapolation" << std::endl;
+    }
+
+    if (const auto& timeToSwitchStart = _player->GetTimeToSwitchStart(); timeToSwitchStart.GetCount() != 0) {
+        std::cout << "Dragged switches: " << timeToSwitchStart.GetCount() << ", " << _player->GetFlickSwitchCount() << " of them flicks, time from the drag start to the switch start: mean "
+                  << timeToSwitchStart.GetMean() << " ms, p50: " << timeToSwitchStart.GetPercentile(50) << " ms, p95: " << timeToSwitchStart.GetPercentile(95) << " ms" << std::endl;
+    }
+}
+
+void Game::RunSingleThreadedLoop()
 {
     auto previous = SDL_GetTicks64();
 
@@ -43,74 +200,406 @@ void Game::RunMainLoop()
         auto now = SDL_GetTicks64();
         auto delta = now - previous;
 
-        ProcessEvents();
+        UpdateSoakBot(now);
+        auto updateStart = SDL_GetPerformanceCounter();
+        bool needsRedraw = ProcessEvents();
+        HandlePointerSamples();
+        _inputProcessor->DispatchQueuedEvents();
 
-        // Update it here, so we have background music in the main menu as well
-        _audioPlayer->Update();
+        if (_inputRecorder) {
+            _inputRecorder->EndFrame(now, delta);
+        }
 
-        _screen->BeginFrame();
+        if (UpdateAndRecordFrame(delta, needsRedraw, _drawList)) {
+            PresentFrame(_drawList);
+            AddSoakUpdateTime(updateStart);
 
-        switch (_gameState) {
-        case Game::GameState::Paused: {
-            _menu->Draw();
-        } break;
-        case Game::GameState::Playing: {
-            _gameWorld->Update(delta);
+            _framePacer->WaitForNextFrame();
+        } else {
+            AddSoakUpdateTime(updateStart);
 
-            if (_gameStateObject->IsGameOver()) {
-                _highScore->AddScore(_gameStateObject->GetGameMode(), _gameStateObject->GetScore());
-                _highScore->WriteHighScore();
+            // Nothing has changed on the screen, so sleep until something happens instead of spinning at the desired FPS
+            SDL_WaitEventTimeout(nullptr, _gameState == GameState::Paused ? MenuIdleWaitTimeMs : int(_framePacer->GetFramePeriodMs()));
+            _framePacer->Restart();
+        }
+
+        previous = now;
+    }
+}
 
-                auto result = _gameStateObject->GetResult();
-                _gameStateObject.reset();
-                EndGame(false, result);
-            } else {
-                _gameWorld->Draw();
+void Game::RunThreadedLoop()
+{
+    _framePublishedEventType = SDL_RegisterEvents(1);
+    // Without the event the new frames have to be polled
+    auto idleWaitTimeMs = _framePublishedEventType != Uint32(-1) ? MenuIdleWaitTimeMs : int(_framePacer->GetFramePeriodMs());
+
+    std::thread simulationThread([this] { RunSimulationLoop(); });
+
+    const DrawList* frame = nullptr;
+
+    while (!_shouldQuit) {
+        bool needsRedraw = false;
+        bool isEventForwarded = false;
+
+        // SDL only delivers the events to the thread that created the window, so they are forwarded from here
+        SDL_Event e;
+        while (SDL_PollEvent(&e) != 0) {
+            if (e.type == _framePublishedEventType) {
+                continue;
             }
-        } break;
+
+            // The window content might have been lost (eg. it was covered or minimized), so the last frame is drawn again
+            needsRedraw = needsRedraw || e.type == SDL_WINDOWEVENT;
+
+            // Before the event is forwarded, so the simulation thread sees the pause with the motion events after it
+            if (_pointerSampler && e.type == SDL_WINDOWEVENT) {
+                _pointerSampler->HandleWindowEvent(e.window);
+            }
+
+            // The simulation thread is woken below, it drains the whole queue, so it can only be full for a moment
+            while (!_inputQueue.TryPush(e) && !_shouldQuit) {
+                NotifyInputAvailable();
+                std::this_thread::yield();
+            }
+
+            isEventForwarded = true;
         }
 
-        _screen->Present();
+        if (isEventForwarded) {
+            NotifyInputAvailable();
+        }
+
+        if (auto latestFrame = _frames.TryAcquireLatest()) {
+            frame = latestFrame;
+            needsRedraw = true;
+        }
+
+        if (needsRedraw && frame) {
+            PresentFrame(*frame);
+
+            _framePacer->WaitForNextFrame();
+        } else {
+            // Wakes up for the next event, including the one pushed when a new frame is published
+            SDL_WaitEventTimeout(nullptr, idleWaitTimeMs);
+            _framePacer->Restart();
+        }
+    }
+
+    simulationThread.join();
+}
+
+void Game::RunSimulationLoop()
+{
+    // The frames are recorded at most at the display rate. The pacer only sleeps, so the thread is idle between them
+    FramePacer framePacer { _targetFps, false, FramePacer::WaitMode::SleepOnly };
+    auto previous = SDL_GetTicks64();
+
+    while (!_shouldQuit) {
+        auto now = SDL_GetTicks64();
+        auto delta = now - previous;
+
+        bool needsRedraw = false;
 
-        if (delta <= FrameTime) {
-            SDL_Delay(uint32_t(FrameTime - delta));
+        // The events are pushed to SDL, so they reach this thread through the main thread like the real ones
+        UpdateSoakBot(now);
+        auto updateStart = SDL_GetPerformanceCounter();
+
+        SDL_Event e;
+        while (_inputQueue.TryPop(e)) {
+            needsRedraw = HandleEvent(e) || needsRedraw;
+        }
+
+        HandlePointerSamples();
+        ProcessMessages();
+        _inputProcessor->DispatchQueuedEvents();
+
+        if (_inputRecorder) {
+            _inputRecorder->EndFrame(now, delta);
+        }
+
+        if (UpdateAndRecordFrame(delta, needsRedraw, _frames.GetWriteBuffer())) {
+            _frames.Publish();
+            NotifyFramePublished();
+            AddSoakUpdateTime(updateStart);
+
+            framePacer.WaitForNextFrame();
+        } else {
+            AddSoakUpdateTime(updateStart);
+
+            // Nothing has changed on the screen, so block until an event is forwarded, like the single threaded loop
+            WaitForInput(_gameState == GameState::Paused ? MenuIdleWaitTimeMs : framePacer.GetFramePeriodMs());
+            framePacer.Restart();
         }
 
         previous = now;
     }
 
-    _highScore->WriteHighScore();
+    // The cascades were started on this thread, so their frames are in its pool, which is freed when the thread exits
+    _gameWorld->CancelTasks();
+
+    // The main thread might be waiting for the events, it has to see the quit
+    NotifyFramePublished();
+}
+
+void Game::WaitForInput(uint32_t timeoutMs)
+{
+    std::unique_lock lock { _inputMutex };
+    _inputAvailable.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return _shouldQuit || !_inputQueue.IsEmpty(); });
+}
+
+void Game::NotifyInputAvailable()
+{
+    // The lock orders the push before the check of a waiting thread, so the notification can't be missed
+    {
+        std::lock_guard lock { _inputMutex };
+    }
+
+    _inputAvailable.notify_one();
 }
 
-void Game::ProcessEvents()
+void Game::NotifyFramePublished()
+{
+    if (_framePublishedEventType != Uint32(-1)) {
+        SDL_Event e {};
+        e.type = _framePublishedEventType;
+        SDL_PushEvent(&e);
+    }
+}
+
+bool Game::UpdateAndRecordFrame(uint64_t deltaTimeMs, bool needsRedraw, DrawList& drawList)
+{
+    // Update it here, so we have background music in the main menu as well
+    _audioPlayer->Update();
+
+    needsRedraw = std::exchange(_isRedrawRequested, false) || needsRedraw;
+
+    switch (_gameState) {
+    case Game::GameState::Paused: {
+        if (needsRedraw || _menu->NeedsRedraw()) {
+            needsRedraw = true;
+
+            drawList.Clear();
+            _menu->Draw(drawList);
+        }
+
+        _simulationAccumulatorMs = 0;
+    } break;
+    case Game::GameState::Playing: {
+        _simulationAccumulatorMs += std::min(deltaTimeMs, MaxSimulatedFrameTimeMs);
+        while (_simulationAccumulatorMs >= SimulationStepMs && !_gameStateObject->IsGameOver()) {
+            _gameWorld->Update(SimulationStepMs);
+            _simulationAccumulatorMs -= SimulationStepMs;
+        }
+
+        if (_gameStateObject->IsGameOver()) {
+            if (!_isReplaying) {
+                _highScore->AddScore(_gameStateObject->GetGameMode(), _gameStateObject->GetScore());
+                SaveHighScoreInBackground();
+            }
+
+            auto result = _gameStateObject->GetResult();
+            _gameStateObject.reset();
+            EndGame(false, result);
+
+            // Show the menu right away instead of waiting for the idle timeout
+            needsRedraw = true;
+
+            drawList.Clear();
+            _menu->Draw(drawList);
+        } else if (needsRedraw || _gameWorld->NeedsRedraw()) {
+            needsRedraw = true;
+
+            // The remaining time is drawn by interpolating between the last 2 steps
+            drawList.Clear();
+            _gameWorld->Draw(drawList, float(_simulationAccumulatorMs) / SimulationStepMs);
+        }
+    } break;
+    }
+
+    if (needsRedraw) {
+        // The visible events that were handled since the last recorded frame are first shown by this one
+        drawList.SetFrameNumber(++_recordedFrameCount);
+        _latencyTracker->AddFrameEvents(_inputProcessor->GetVisibleEvents(), _recordedFrameCount);
+        _inputProcessor->ClearVisibleEvents();
+    }
+
+    return needsRedraw;
+}
+
+void Game::PresentFrame(const DrawList& frame)
+{
+    _screen->BeginFrame();
+    frame.Execute(*_screen);
+
+    if (_showLatencyOverlay) {
+        DrawLatencyOverlay();
+    }
+
+    _screen->Present();
+    _latencyTracker->OnFramePresented(frame.GetFrameNumber());
+}
+
+void Game::DrawLatencyOverlay()
+{
+    static constexpr int lineWidth = 260;
+    static constexpr int lineHeight = 22;
+    static constexpr int margin = 10;
+
+    auto lines = _latencyTracker->GetSummaryLines();
+    lines.insert(lines.begin(), "Input latency p50 / p95 / p99");
+
+    SDL_Rect lineRect { 2 * margin, 2 * margin, lineWidth, lineHeight };
+    _screen->DrawBackgroundRectangle(SDL_Rect { margin, margin, lineWidth + 2 * margin, int(lines.size()) * lineHeight + 2 * margin });
+
+    for (const auto& line : lines) {
+        _screen->DrawText(line, lineRect, false, SDL_Color { 255, 255, 255, 255 });
+        lineRect.y += lineHeight;
+    }
+}
+
+bool Game::ProcessEvents()
 {
     SDL_Event e;
+    bool needsRedraw = false;
 
     while (SDL_PollEvent(&e) != 0) {
-        switch (e.type) {
-        case SDL_QUIT: {
-            _shouldQuit = true;
-        } break;
-        case SDL_MOUSEMOTION:
-        case SDL_MOUSEBUTTONDOWN:
-        case SDL_MOUSEBUTTONUP: {
-            _inputProcessor->ProcessMouseEvent(e);
-        } break;
-        case SDL_KEYDOWN: {
-            _inputProcessor->ProcessKeyEvent(e);
-        } break;
-        default:
-            break;
+        needsRedraw = HandleEvent(e) || needsRedraw;
+    }
+
+    ProcessMessages();
+
+    return needsRedraw;
+}
+
+void Game::ProcessMessages()
+{
+    GameMessage message;
+    while (_messages.TryPop(message)) {
+        if (auto* highScoreSaved = std::get_if<HighScoreSavedMessage>(&message); highScoreSaved && !highScoreSaved->IsSuccessful) {
+            std::cerr << "Failed to save the high scores" << std::endl;
+        }
+    }
+}
+
+void Game::SaveHighScoreInBackground()
+{
+    // Only one write at a time, so an older list can't overwrite a newer one
+    if (_highScoreWriter.joinable()) {
+        _highScoreWriter.join();
+    }
+
+    _highScoreWriter = std::thread([this, highScore = *_highScore]() mutable {
+        auto isSuccessful = highScore.WriteHighScore();
+
+        // The queue can only be full if the game thread stopped draining it, then nobody needs the result
+        _messages.TryPush(HighScoreSavedMessage { isSuccessful });
+    });
+}
+
+bool Game::HandleEvent(const SDL_Event& e)
+{
+    if (_pointerSampler) {
+        if (e.type == SDL_MOUSEMOTION && !_pointerSampler->IsPaused()) {
+            // The samples are used instead
+            return false;
+        } else if (e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEBUTTONUP) {
+            // The presses and releases still come from SDL, the samples before them are handled first to keep the order
+            HandlePointerSamples(e.common.timestamp);
+        } else if (e.type == SDL_WINDOWEVENT && !_useSimulationThread) {
+            // With the simulation thread this is called on it, and the main thread handles the window events while polling
+            _pointerSampler->HandleWindowEvent(e.window);
+        }
+    }
+
+    if (_inputRecorder) {
+        _inputRecorder->AddEvent(e);
+    }
+
+    switch (e.type) {
+    case SDL_QUIT: {
+        _shouldQuit = true;
+    } break;
+    case SDL_WINDOWEVENT: {
+        // The window content might have been lost (eg. it was covered or minimized), so it has to be redrawn
+        return true;
+    }
+    case SDL_MOUSEMOTION:
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP: {
+        _inputProcessor->ProcessMouseEvent(e);
+    } break;
+    case SDL_KEYDOWN: {
+        _inputProcessor->ProcessKeyEvent(e);
+    } break;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+void Game::UpdateSoakBot(uint64_t nowMs)
+{
+    if (_soakBot) {
+        _soakBot->Update(nowMs, *_menu, *_gameWorld, _gameState == GameState::Playing, *_inputProcessor);
+    }
+}
+
+void Game::AddSoakUpdateTime(uint64_t updateStart)
+{
+    if (_soakBot) {
+        _soakBot->AddUpdateTime(double(SDL_GetPerformanceCounter() - updateStart) * 1000.0 / double(SDL_GetPerformanceFrequency()));
+    }
+}
+
+void Game::HandlePointerSamples(std::optional<uint32_t> untilTimestampMs)
+{
+    if (!_pointerSampler) {
+        return;
+    }
+
+    PointerSample sample;
+    while (_pointerSampler->TryPopSample(untilTimestampMs, sample)) {
+        auto e = ToMouseMotionEvent(sample);
+
+        // Recorded as motion events, so the replays don't need the sampler
+        if (_inputRecorder) {
+            _inputRecorder->AddEvent(e);
         }
+
+        _inputProcessor->ProcessMouseEvent(e);
     }
 }
 
 void Game::HandleKeyPress(Key key)
 {
+    // Every key changes what is drawn
+    _inputProcessor->MarkCurrentEventVisible();
+
     switch (key) {
     case Key::Escape: {
         ToggleIsPlaying();
     } break;
+    case Key::CycleAnimationSpeed: {
+        // 1x -> 2x -> 4x -> instant -> 1x, the per category scales are kept
+        auto speed = _gameWorld->GetAnimationSpeed();
+        if (speed.IsInstant) {
+            speed.IsInstant = false;
+            speed.GlobalScale = 1.0f;
+        } else if (speed.GlobalScale < 2.0f) {
+            speed.GlobalScale = 2.0f;
+        } else if (speed.GlobalScale < 4.0f) {
+            speed.GlobalScale = 4.0f;
+        } else {
+            speed.IsInstant = true;
+        }
+
+        _gameWorld->SetAnimationSpeed(speed);
+    } break;
+    case Key::ToggleLatencyOverlay: {
+        _showLatencyOverlay = !_showLatencyOverlay;
+        _isRedrawRequested = true;
+    } break;
     }
 }
 
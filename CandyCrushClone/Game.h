@@ -1,18 +1,40 @@
 #pragma once
 
 #include "AudioPlayer.h"
+#include "DrawList.h"
+#include "FramePacer.h"
+#include "GameMessage.h"
 #include "GameMode.h"
+#include "GameOptions.h"
 #include "GameWorld.h"
 #include "HighScore.h"
+#include "InputRecording.h"
+#include "LatencyTracker.h"
 #include "MainMenu.h"
 #include "Player.h"
+#include "MpscQueue.h"
+#include "PointerSampler.h"
 #include "Screen.h"
+#include "SoakBot.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+#include <SDL.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
 
 class Game {
 public:
-    Game();
+    explicit Game(const GameOptions& options);
 
     void RunMainLoop();
+    // Feeds the recorded events to the game without waiting, and prints the time spent on the updates and the draws
+    void RunReplay(const InputReplay& replay);
 
 private:
     enum class GameState {
@@ -20,8 +42,13 @@ private:
         Playing,
     };
 
-    static constexpr int DesiredFPS = 60;
-    static constexpr int FrameTime = int(1000.f / DesiredFPS);
+    static constexpr int MenuIdleWaitTimeMs = 250; // The audio player still needs regular updates to start the next track
+    // The game world is always updated with this time step (250 Hz), so the game doesn't depend on the frame rate
+    static constexpr uint64_t SimulationStepMs = 4;
+    // Longer frames (eg. while the window is dragged) are cut to this, so the simulation can't fall behind indefinitely
+    static constexpr uint64_t MaxSimulatedFrameTimeMs = 250;
+    static constexpr size_t InputQueueCapacity = 1024;
+    static constexpr size_t MessageQueueCapacity = 256;
 
     std::unique_ptr<Screen> _screen;
     std::unique_ptr<InputProcessor> _inputProcessor;
@@ -30,15 +57,73 @@ private:
     std::unique_ptr<Player> _player;
     std::unique_ptr<HighScore> _highScore;
     std::unique_ptr<AudioPlayer> _audioPlayer;
+    std::unique_ptr<FramePacer> _framePacer;
+    std::unique_ptr<LatencyTracker> _latencyTracker;
+    std::unique_ptr<InputRecorder> _inputRecorder;
+    // Replaces the motion events of SDL if the pointer sampling is enabled
+    std::unique_ptr<PointerSampler> _pointerSampler;
+    std::unique_ptr<SoakBot> _soakBot;
 
-    bool _shouldQuit = false;
+    std::atomic<bool> _shouldQuit = false;
+    bool _printFrameStatistics = false;
+    bool _useSimulationThread = false;
+    int _targetFps = 60;
+    // Toggled on the thread handling the input, read by the thread presenting the frames
+    std::atomic<bool> _showLatencyOverlay = false;
+    std::optional<std::string> _latencyHistogramFilePath;
+    // Set by the input handlers whose changes aren't tracked by the menu or the game world
+    bool _isRedrawRequested = false;
+    // The replayed games don't change the saved high scores
+    bool _isReplaying = false;
+    uint64_t _recordedFrameCount = 0;
     GameState _gameState = GameState::Paused;
+    // The frame time that wasn't simulated yet, always less than a step after the updates of a frame
+    uint64_t _simulationAccumulatorMs = 0;
 
-    std::unique_ptr<EventToken> _keyPressedToken;
-    std::unique_ptr<EventToken> _mouseClickedToken;
+    // The frame recorded by the single threaded loop
+    DrawList _drawList;
+    // With the simulation thread, the frames are recorded on it and drawn on the main thread
+    TripleBuffer<DrawList> _frames;
+    // The SDL events forwarded from the main thread to the simulation thread
+    SpscQueue<SDL_Event, InputQueueCapacity> _inputQueue;
+    // The simulation thread blocks on these while nothing changes on the screen, until an event is forwarded
+    std::mutex _inputMutex;
+    std::condition_variable _inputAvailable;
+    // Pushed to SDL by the simulation thread after it published a frame, so the main thread can block on the events
+    Uint32 _framePublishedEventType = 0;
+    // The results of the background threads, drained together with the events
+    MpscQueue<GameMessage, MessageQueueCapacity> _messages;
+    std::thread _highScoreWriter;
+
+    EventToken _keyPressedToken;
+    EventToken _mouseClickedToken;
     std::unique_ptr<IGameState> _gameStateObject;
 
-    void ProcessEvents();
+    void RunSingleThreadedLoop();
+    // The main thread polls the events and draws the frames, the simulation runs on its own thread
+    void RunThreadedLoop();
+    void RunSimulationLoop();
+    void WaitForInput(uint32_t timeoutMs);
+    void NotifyInputAvailable();
+    void NotifyFramePublished();
+    // Updates the menu or the game world, and records a frame if the screen changed. Returns true if it recorded one
+    bool UpdateAndRecordFrame(uint64_t deltaTimeMs, bool needsRedraw, DrawList& drawList);
+    // Draws the frame, with the latency overlay on top if it is enabled, and completes the latency of its input events
+    void PresentFrame(const DrawList& frame);
+    void DrawLatencyOverlay();
+    void PrintDragStatistics() const;
+
+    bool ProcessEvents();
+    void ProcessMessages();
+    // Writes a copy of the high scores on a background thread, the result is sent back as a message
+    void SaveHighScoreInBackground();
+    // Returns true if the screen has to be redrawn
+    bool HandleEvent(const SDL_Event& e);
+    void UpdateSoakBot(uint64_t nowMs);
+    // The update started at the given performance counter value
+    void AddSoakUpdateTime(uint64_t updateStart);
+    // Handles the pointer samples taken at or before the given time as motion events, every sample without a time
+    void HandlePointerSamples(std::optional<uint32_t> untilTimestampMs = std::nullopt);
     void HandleKeyPress(Key key);
     void HandleButtonClicked(ButtonType button);
     void ToggleIsPlaying();
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <variant>
+
+// The messages sent from the background threads to the game thread, see Game::ProcessMessages
+
+struct HighScoreSavedMessage {
+    bool IsSuccessful = false;
+};
+
+using GameMessage = std::variant<HighScoreSavedMessage>;
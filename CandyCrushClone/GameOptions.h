@@ -0,0 +1,42 @@
+#pragma once
+
+#include "AnimationSpeed.h"
+#include "InputRecording.h"
+
+#include <optional>
+#include <string>
+
+struct GameOptions {
+    // Composite the board on the CPU with the SIMD blitter instead of the SDL renderer. Faster when there is no GPU
+    bool UseSoftwareBlitter = false;
+    // The number of threads rasterizing the tiles of the software blitter, 0 means every hardware thread
+    int SoftwareBlitterThreadCount = 0;
+    // The starting speed of the board animations, can be changed during the game with the S key
+    AnimationSpeed Speed;
+    // The frame rate while something is animating
+    int TargetFps = 60;
+    // Let Present wait for the display instead of pacing the frames with the timer
+    bool UseVsync = false;
+    // Print the frame time statistics at exit
+    bool PrintFrameStatistics = false;
+    // Run the menu and the game world on a separate thread, the main thread only polls the events and draws the frames
+    bool UseSimulationThread = false;
+    // Show the input latency percentiles in the corner, can be toggled during the game with the L key
+    bool ShowLatencyOverlay = false;
+    // Write the input latency histograms to this file at exit
+    std::optional<std::string> LatencyHistogramFilePath;
+    // Draw the dragged cell where the cursor is expected to be when the frame is presented
+    bool UseDragPrediction = true;
+    // Switch the dragged cell as soon as the drag is recognized as a flick, see Player::SetFlickSwitchEnabled
+    bool UseFlickSwitches = true;
+    // Read the mouse position about every millisecond on a separate thread instead of relying on the motion events
+    bool UsePointerSampling = false;
+    // Record the handled events to this file, see InputRecorder
+    std::optional<std::string> InputRecordingFilePath;
+    // Generated from std::random_device if not set
+    std::optional<RandomSeeds> Seeds;
+    // Draw into an offscreen surface without sound, for replaying the recordings
+    bool IsHeadless = false;
+    // Let the SoakBot play for this long, then quit
+    std::optional<int> SoakMinutes;
+};
@@ -36,7 +36,7 @@ public:
 
 private:
     static constexpr int ScoreToReach = 3000;
-    int _score;
+    int _score = 0;
 };
 
 class QuickDeathGameState : public IGameState {
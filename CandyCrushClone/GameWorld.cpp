@@ -1,5 +1,8 @@
 #include "GameWorld.h"
 
+#include <algorithm>
+#include <sstream>
+
 namespace {
 bool Contains(const std::array<int, 2>& arr, int value)
 {
@@ -12,11 +15,6 @@ Cell::Cell(int type)
 {
 }
 
-void Cell::Destroy()
-{
-    State = CellState::Destroyed;
-}
-
 int GameWorld::GetRandomNumber(const std::array<int, 2>& excluding)
 {
     int randomNumber = _randomDistribution(_randomEngine);
@@ -56,14 +54,16 @@ void GameWorld::FillBoard()
     }
 }
 
-GameWorld::GameWorld(int rowCount, int colCount, int tileKindCount, Screen& screen, AudioPlayer& audioPlayer)
+GameWorld::GameWorld(int rowCount, int colCount, int tileKindCount, Screen& screen, AudioPlayer& audioPlayer, unsigned int randomSeed)
     : RowCount(rowCount)
     , ColCount(colCount)
     , TileKindCount(tileKindCount)
     , _screen(&screen)
-    , _randomEngine(_randomDevice())
+    , _randomEngine(randomSeed)
     , _randomDistribution(0, tileKindCount - 1) // Random distribution is inclusive on both ends, so the range [0, n - 1] will contain n possible values
     , _audioPlayer(&audioPlayer)
+    , _fallSimulator(TileSize)
+    , _particles(randomSeed)
 {
     FillBoard();
 }
@@ -71,10 +71,14 @@ GameWorld::GameWorld(int rowCount, int colCount, int tileKindCount, Screen& scre
 void GameWorld::Activate(IGameState& gameState)
 {
     _isActive = true;
+    _needsRedraw = true;
 
     if (_gameState != &gameState) {
         _gameState = &gameState;
-        _animationState.reset();
+        _animations.Clear();
+        _fallSimulator.Clear();
+        _particles.Clear();
+        _tasks.clear();
         _activeCellState.reset();
         FillBoard();
     }
@@ -85,63 +89,80 @@ void GameWorld::Deactivate()
     _isActive = false;
 }
 
-void GameWorld::Draw()
+void GameWorld::CancelTasks()
+{
+    // The animations would resume the destroyed coroutines
+    _animations.Clear();
+    _tasks.clear();
+}
+
+void GameWorld::Draw(DrawList& drawList, float interpolationAlpha)
 {
+    _needsRedraw = false;
+
     for (int i = 0; i < _gameBoard.size(); ++i) {
         auto& currentRow = _gameBoard[i];
         for (int j = 0; j < currentRow.size(); ++j) {
             if (_gameBoard[i][j].State == Cell::CellState::Normal) {
-                _screen->DrawCell(Vec2 { i * TileSize, j * TileSize }, _gameBoard[i][j].Type, TileSize, TileSize);
+                drawList.DrawCell(Vec2 { i * TileSize, j * TileSize }, _gameBoard[i][j].Type, TileSize, TileSize);
             }
         }
     }
 
     if (_activeCellState) {
         // Make a periodic function with a period of 1 second and in the range [0, 0.2]
-        auto scaleDiff = (sin(_activeCellState->AnimationTimePassed / 1000.f * 2 * M_PI)) * 0.1;
+        auto scaleDiff = Easing::SinTurns(_activeCellState->AnimationTimePassed / 1000.f) * 0.1;
         auto newSize = TileSize * (1 + scaleDiff);
         auto halfDiff = int((newSize - TileSize) / 2.0);
 
-        _screen->DrawCell(
-            _activeCellState->Index * TileSize - Vec2 { halfDiff, halfDiff } + _activeCellState->Offset,
+        drawList.DrawCell(
+            _activeCellState->Index * TileSize - Vec2 { halfDiff, halfDiff } + _activeCellState->Offset + _activeCellState->PredictedOffset,
             At(_activeCellState->Index).Type,
             TileSize,
             int(newSize));
     }
 
-    if (_animationState) {
-        if (std::holds_alternative<std::vector<CellAnimationMoveData>>(_animationState->AnimationData)) {
-            auto& animationData = std::get<std::vector<CellAnimationMoveData>>(_animationState->AnimationData);
-            for (const auto& [startPosition, endPosition, cellType, startPositionOverride] : animationData) {
-                auto realStartPosition = startPositionOverride.value_or(startPosition);
-                _screen->DrawCell(realStartPosition.Lerp(endPosition, _animationState->AnimationProgress), cellType, TileSize, TileSize);
-            }
-        } else if (std::holds_alternative<std::vector<CellAnimationDestructionData>>(_animationState->AnimationData)) {
-            auto& animationData = std::get<std::vector<CellAnimationDestructionData>>(_animationState->AnimationData);
-            for (const auto& [cellIndex, cellType] : animationData) {
-                double newSize = (1 - _animationState->AnimationProgress) * TileSize;
-                auto halfDiff = int((TileSize - newSize) / 2);
-                auto offset = Vec2 { halfDiff, halfDiff };
-
-                _screen->DrawCell(cellIndex * TileSize + Vec2 { halfDiff, halfDiff }, cellType, TileSize, int(newSize));
-                _screen->DrawDestroyAnimation(cellIndex * TileSize, TileSize, _animationState->AnimationProgress);
-            }
+    _fallSimulator.ForEach([&drawList](Vec2 position, int cellType) {
+        drawList.DrawCell(position, cellType, TileSize, TileSize);
+    },
+        interpolationAlpha);
+
+    _animations.ForEach([&drawList](const CellAnimation& animation, double progress) {
+        for (const auto& [startPosition, endPosition, cellType, startPositionOverride] : animation.Moves) {
+            auto realStartPosition = startPositionOverride.value_or(startPosition);
+            drawList.DrawCell(realStartPosition.Lerp(endPosition, progress), cellType, TileSize, TileSize);
         }
-    }
+
+        for (const auto& [cellIndex, cellType] : animation.Destructions) {
+            double newSize = (1 - progress) * TileSize;
+            auto halfDiff = int((TileSize - newSize) / 2);
+
+            drawList.DrawCell(cellIndex * TileSize + Vec2 { halfDiff, halfDiff }, cellType, TileSize, int(newSize));
+            drawList.DrawDestroyAnimation(cellIndex * TileSize, TileSize, progress);
+        }
+    },
+        interpolationAlpha);
+
+    drawList.DrawParticles(_particles);
 
     static constexpr int spacing = 50;
     static constexpr int textWidth = 240;
     static constexpr int textHeight = 40;
 
-    auto textLines = _gameState->GetUIText();
+    _lastDrawnUIText = _gameState->GetUIText();
+    auto textLines = _lastDrawnUIText;
+    if (auto speedText = GetAnimationSpeedText()) {
+        textLines.push_back(std::move(*speedText));
+    }
+
     auto textPosition = 560 + (_screen->ScreenWidth - 560 - textWidth) / 2;
     SDL_Rect textRect { textPosition, 50, textWidth, textHeight };
     SDL_Rect uIBackgroundRect { textRect.x - spacing, textRect.y - spacing, textRect.w + 2 * spacing, int(textLines.size() + 2) * spacing };
 
-    _screen->DrawBackgroundRectangle(uIBackgroundRect);
+    drawList.DrawBackgroundRectangle(uIBackgroundRect);
 
     for (const auto& line : textLines) {
-        _screen->DrawText(line, textRect, true);
+        drawList.DrawText(line, textRect, true);
         textRect.y += spacing;
     }
 }
@@ -150,89 +171,123 @@ void GameWorld::Update(uint64_t deltaTimeMs)
 {
     _gameState->Update(int(deltaTimeMs));
 
-    if (_animationState) {
-        _animationState->AnimationTimePassed += deltaTimeMs;
-
-        double rawProgress = _animationState->AnimationTimePassed / _animationState->AnimationDuration;
+    _particles.Update(float(deltaTimeMs) * _animationSpeed.GetScale(AnimationCategory::Particles));
 
-        if (_animationState->EffectToPlay) {
-            _audioPlayer->PlaySoundEffect(*_animationState->EffectToPlay);
-            _animationState->EffectToPlay.reset();
-        } else if (rawProgress > 1.0) {
-            auto completion = std::move(_animationState->Completion);
+    UpdateBoardAnimations(deltaTimeMs);
 
-            for (auto& column : _gameBoard) {
-                for (auto& cell : column) {
-                    if (cell.State == Cell::CellState::WaitingForAnimationToComplete) {
-                        cell.State = _animationState->FinalCellState;
-                    }
-                }
-            }
+    if (_animationSpeed.IsInstant) {
+        // Play everything that the last move started to its end, so only the resolved board is drawn
+        for (int i = 0; i < MaxInstantModeSteps && IsBoardAnimating(); ++i) {
+            UpdateBoardAnimations(InstantModeStepMs);
+        }
+    }
 
-            _animationState.reset();
+    if (_activeCellState) {
+        _activeCellState->AnimationTimePassed += deltaTimeMs;
 
-            if (completion) {
-                completion();
-            }
+        if (_activeCellState->PredictionTimeLeftMs > deltaTimeMs) {
+            _activeCellState->PredictionTimeLeftMs -= deltaTimeMs;
         } else {
-            switch (_animationState->EasingFun) {
-            case EasingFunction::EaseInCubic: {
-                _animationState->AnimationProgress = pow(rawProgress, 3);
-            } break;
-            case EasingFunction::EaseOutBounce: {
-                // Taken from https://easings.net/#easeOutBounce
-                static const double n1 = 7.5625;
-                static const double d1 = 2.75;
-                double x = rawProgress;
-                double animationProgress;
-
-                if (x < 1 / d1) {
-                    animationProgress = n1 * x * x;
-                } else if (x < 2 / d1) {
-                    x -= 1.5 / d1;
-                    animationProgress = n1 * x * x + 0.75;
-                } else if (x < 2.5 / d1) {
-                    x -= 2.25 / d1;
-                    animationProgress = n1 * x * x + 0.9375;
-                } else {
-                    x -= 2.625 / d1;
-                    animationProgress = n1 * x * x + 0.984375;
-                }
-                _animationState->AnimationProgress = animationProgress;
-            } break;
-            }
+            _activeCellState->PredictedOffset = Vec2 { 0, 0 };
+            _activeCellState->PredictionTimeLeftMs = 0;
         }
     }
+}
 
-    if (_activeCellState) {
-        _activeCellState->AnimationTimePassed += deltaTimeMs;
+void GameWorld::UpdateBoardAnimations(uint64_t deltaTimeMs)
+{
+    _animations.Update(deltaTimeMs, [this](AnimationTrackId, CellAnimation& animation) {
+        for (auto index : animation.ControlledCells) {
+            assert(At(index).State == Cell::CellState::WaitingForAnimationToComplete);
+            At(index).State = animation.FinalCellState;
+        }
+
+        _needsRedraw = true;
+
+        if (auto continuation = std::exchange(animation.Continuation, nullptr)) {
+            continuation.resume();
+        }
+    });
+
+    auto fallDeltaTimeMs = float(deltaTimeMs) * _animationSpeed.GetScale(AnimationCategory::Fall);
+    if (const auto& landedCells = _fallSimulator.Update(fallDeltaTimeMs); !landedCells.empty()) {
+        for (auto index : landedCells) {
+            assert(At(index).State == Cell::CellState::WaitingForAnimationToComplete);
+            At(index).State = Cell::CellState::Normal;
+        }
+
+        _needsRedraw = true;
+        Spawn(RunCascade());
+    }
+
+    std::erase_if(_tasks, [](const Task& task) { return task.IsDone(); });
+}
+
+bool GameWorld::IsBoardAnimating() const
+{
+    return _animations.GetActiveTrackCount() > 0 || _fallSimulator.GetFallingTileCount() > 0;
+}
+
+void GameWorld::SetAnimationSpeed(const AnimationSpeed& speed)
+{
+    _animationSpeed = speed;
+    _needsRedraw = true;
+}
+
+const AnimationSpeed& GameWorld::GetAnimationSpeed() const
+{
+    return _animationSpeed;
+}
+
+double GameWorld::GetScaledDuration(AnimationCategory category, double durationMs) const
+{
+    return durationMs / _animationSpeed.GetScale(category);
+}
+
+std::optional<std::string> GameWorld::GetAnimationSpeedText() const
+{
+    if (_animationSpeed.IsInstant) {
+        return "Speed: instant";
     }
+
+    if (_animationSpeed.GlobalScale != 1.0f) {
+        std::ostringstream text;
+        text << "Speed: " << _animationSpeed.GlobalScale << "x";
+        return text.str();
+    }
+
+    return std::nullopt;
+}
+
+bool GameWorld::NeedsRedraw()
+{
+    return _needsRedraw || IsBoardAnimating() || _particles.GetParticleCount() > 0 || _activeCellState || _gameState->GetUIText() != _lastDrawnUIText;
 }
 
 bool GameWorld::IsInteractionEnabled() const
 {
-    return _isActive && !_animationState.has_value();
+    return _isActive;
+}
+
+bool GameWorld::IsCellInteractable(Vec2 index) const
+{
+    auto state = At(index).State;
+    return _isActive && (state == Cell::CellState::Normal || state == Cell::CellState::Active);
 }
 
 void GameWorld::SetActiveCell(std::optional<Vec2> index, Vec2 offset)
 {
+    _needsRedraw = true;
+
     if (index) {
         if (abs(offset.x) > DragOffsetSuccessThreshold) { // Successful drag in the x direction
-            if (auto newCell = *index + Vec2 { offset.x > 0 ? 1 : -1, 0 }; IsIndexOnTheBoard(newCell)) {
-                if (TrySwitchCells(*index, newCell, true)) {
-                    TileDragCompleted.Invoke(*index);
-                }
-            }
+            TrySwitchDraggedCell(*index, Vec2 { offset.x > 0 ? 1 : -1, 0 });
         } else if (abs(offset.y) > DragOffsetSuccessThreshold) { // Successful drag in the y direction
-            if (auto newCell = *index + Vec2 { 0, offset.y > 0 ? 1 : -1 }; IsIndexOnTheBoard(newCell)) {
-                if (TrySwitchCells(*index, newCell, true)) {
-                    TileDragCompleted.Invoke(*index);
-                }
-            }
+            TrySwitchDraggedCell(*index, Vec2 { 0, offset.y > 0 ? 1 : -1 });
         } else { // Just update the drag state (eg. cell position)
             if (_activeCellState && _activeCellState->Index == index) {
                 _activeCellState->Offset = offset;
-            } else {
+            } else if (IsCellInteractable(*index)) {
                 _activeCellState.emplace(
                     *index, offset, 0);
                 At(*index).State = Cell::CellState::Active;
@@ -244,12 +299,14 @@ void GameWorld::SetActiveCell(std::optional<Vec2> index, Vec2 offset)
             if (At(activeIndex).State == Cell::CellState::Active) {
                 At(activeIndex).State = Cell::CellState::Normal;
 
+                // The column of the cell was not resolved while it was held
                 if (offset != Vec2 { 0, 0 }) {
-                    MoveCellsAnimated({ CellAnimationMoveData { Vec2 {},
-                                          activeIndex,
-                                          At(activeIndex).Type,
-                                          activeIndex * TileSize + _activeCellState->Offset } },
-                        CellSwitchAnimationDurationMs, nullptr);
+                    Spawn(MoveCellsAndRunCascade(CellAnimationMoveData { Vec2 {},
+                        activeIndex,
+                        At(activeIndex).Type,
+                        activeIndex * TileSize + _activeCellState->Offset }));
+                } else {
+                    Spawn(RunCascade());
                 }
             }
             _activeCellState.reset();
@@ -257,6 +314,31 @@ void GameWorld::SetActiveCell(std::optional<Vec2> index, Vec2 offset)
     }
 }
 
+void GameWorld::SetActiveCellPrediction(Vec2 predictedOffset, uint64_t durationMs)
+{
+    if (_activeCellState) {
+        // A dragged cell is switched before it gets past the threshold, so the predicted one isn't drawn further either
+        auto offset = _activeCellState->Offset;
+        auto drawnOffset = Vec2 {
+            std::clamp(offset.x + predictedOffset.x, -DragOffsetSuccessThreshold, DragOffsetSuccessThreshold),
+            std::clamp(offset.y + predictedOffset.y, -DragOffsetSuccessThreshold, DragOffsetSuccessThreshold)
+        };
+
+        _activeCellState->PredictedOffset = drawnOffset - offset;
+        _activeCellState->PredictionTimeLeftMs = durationMs;
+        _needsRedraw = true;
+    }
+}
+
+std::optional<Vec2> GameWorld::GetActiveCellOffset(bool isPredictionIncluded) const
+{
+    if (!_activeCellState) {
+        return std::nullopt;
+    }
+
+    return isPredictionIncluded ? _activeCellState->Offset + _activeCellState->PredictedOffset : _activeCellState->Offset;
+}
+
 bool GameWorld::TrySwitchCells(Vec2 lhs, Vec2 rhs, bool isDraggedCellTheSource)
 {
     assert(lhs.x >= 0 && lhs.x < RowCount);
@@ -266,42 +348,69 @@ bool GameWorld::TrySwitchCells(Vec2 lhs, Vec2 rhs, bool isDraggedCellTheSource)
     assert(!isDraggedCellTheSource || _activeCellState);
 
     if (lhs.DistanceSquared(rhs) == 1) {
-        auto tmp = At(lhs);
-        At(lhs) = At(rhs);
-        At(rhs) = tmp;
-
-        // Check if we can destroy something in the new state
-        auto cellsToDestroy = GetCellsToDestroyFromCurrentState();
-
-        // Restore the original state
-        tmp = At(lhs);
-        At(lhs) = At(rhs);
-        At(rhs) = tmp;
+        bool canSwitch = IsCellInteractable(lhs) && IsCellInteractable(rhs) && !GetCellsToDestroyAfterSwitch(lhs, rhs).DestroyedCells.empty();
 
-        if (!cellsToDestroy.DestroyedCells.empty()) {
-            MoveCellsAnimated(
-                {
-                    CellAnimationMoveData { lhs, rhs, At(lhs).Type, isDraggedCellTheSource ? _activeCellState->Index * TileSize + _activeCellState->Offset : std::optional<Vec2>() },
-                    CellAnimationMoveData { rhs, lhs, At(rhs).Type, std::nullopt },
-                },
-                CellSwitchAnimationDurationMs, [this]() { UpdateBoardState(); });
+        if (canSwitch) {
+            Spawn(MoveCellsAndRunCascade(
+                CellAnimationMoveData { lhs, rhs, At(lhs).Type, isDraggedCellTheSource ? _activeCellState->Index * TileSize + _activeCellState->Offset : std::optional<Vec2>() },
+                CellAnimationMoveData { rhs, lhs, At(rhs).Type, std::nullopt }));
 
             return true;
         } else if (_activeCellState) { // Just move back the moved cell to its original position
             // This will only be invoked if we are dragging a cell, otherwise activeCellState is already reset
             auto activeIndex = _activeCellState->Index;
-            MoveCellsAnimated({ CellAnimationMoveData { Vec2 {},
-                                  activeIndex,
-                                  At(activeIndex).Type,
-                                  activeIndex * TileSize + _activeCellState->Offset } },
-                CellSwitchAnimationDurationMs, nullptr);
-            TileDragCompleted.Invoke(activeIndex);
+            Spawn(MoveCellsAndRunCascade(CellAnimationMoveData { Vec2 {},
+                activeIndex,
+                At(activeIndex).Type,
+                activeIndex * TileSize + _activeCellState->Offset }));
+            TileDragCompleted.Invoke(activeIndex, false);
         }
     }
 
     return false;
 }
 
+bool GameWorld::TrySwitchActiveCell(Vec2 direction)
+{
+    if (!_activeCellState) {
+        return false;
+    }
+
+    auto index = _activeCellState->Index;
+    auto newCell = index + direction;
+    if (!IsIndexOnTheBoard(newCell) || !IsCellInteractable(newCell) || GetCellsToDestroyAfterSwitch(index, newCell).DestroyedCells.empty()) {
+        return false;
+    }
+
+    return TrySwitchDraggedCell(index, direction);
+}
+
+bool GameWorld::TrySwitchDraggedCell(Vec2 index, Vec2 direction)
+{
+    if (auto newCell = index + direction; IsIndexOnTheBoard(newCell) && TrySwitchCells(index, newCell, true)) {
+        TileDragCompleted.Invoke(index, true);
+        return true;
+    }
+
+    return false;
+}
+
+std::optional<std::pair<Vec2, Vec2>> GameWorld::FindValidSwitch()
+{
+    for (int i = 0; i < ColCount; ++i) {
+        for (int j = 0; j < RowCount; ++j) {
+            // It's enough to check the right and bottom neighbors, the others were already checked from their side
+            for (auto neighbor : { Vec2 { i + 1, j }, Vec2 { i, j + 1 } }) {
+                if (IsIndexOnTheBoard(neighbor) && IsCellInteractable(Vec2 { i, j }) && IsCellInteractable(neighbor) && !GetCellsToDestroyAfterSwitch(Vec2 { i, j }, neighbor).DestroyedCells.empty()) {
+                    return std::make_pair(Vec2 { i, j }, neighbor);
+                }
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
 std::optional<Vec2> GameWorld::GetTileIndicesAtPoint(Vec2 position)
 {
     Vec2 possibleResult = position / TileSize;
@@ -312,6 +421,11 @@ std::optional<Vec2> GameWorld::GetTileIndicesAtPoint(Vec2 position)
     return std::nullopt;
 }
 
+Vec2 GameWorld::GetCellCenter(Vec2 index) const
+{
+    return index * TileSize + Vec2 { TileSize / 2, TileSize / 2 };
+}
+
 Cell& GameWorld::At(Vec2 indices)
 {
     assert(indices.x >= 0 && indices.x < ColCount);
@@ -328,19 +442,28 @@ const Cell& GameWorld::At(Vec2 indices) const
     return _gameBoard[indices.x][indices.y];
 }
 
-CellDestructionData GameWorld::GetCellsToDestroyFromCurrentState() const
+CellDestructionData GameWorld::GetCellsToDestroyFromCurrentState(bool includeActiveCells) const
 {
     std::vector<Vec2> cellsToRemove;
 
+    auto isMatchable = [includeActiveCells](const Cell& cell) {
+        return cell.State == Cell::CellState::Normal || (includeActiveCells && cell.State == Cell::CellState::Active);
+    };
+
     int maxColStreak = 0;
     // Check the columns for at least 3 of the same cells next to each other
     for (int i = 0; i < ColCount; ++i) {
         int j = 0;
         while (j < RowCount - 2) {
+            if (!isMatchable(_gameBoard[i][j])) {
+                ++j;
+                continue;
+            }
+
             int k = j + 1;
 
             // Keep going until we find a cell that is different from the current one
-            while (k < RowCount && _gameBoard[i][j].Type == _gameBoard[i][k].Type) {
+            while (k < RowCount && isMatchable(_gameBoard[i][k]) && _gameBoard[i][j].Type == _gameBoard[i][k].Type) {
                 ++k;
             }
 
@@ -362,9 +485,14 @@ CellDestructionData GameWorld::GetCellsToDestroyFromCurrentState() const
     for (int j = 0; j < RowCount; ++j) {
         int i = 0;
         while (i < ColCount - 2) {
+            if (!isMatchable(_gameBoard[i][j])) {
+                ++i;
+                continue;
+            }
+
             int k = i + 1;
 
-            while (k < ColCount && _gameBoard[i][j].Type == _gameBoard[k][j].Type) {
+            while (k < ColCount && isMatchable(_gameBoard[k][j]) && _gameBoard[i][j].Type == _gameBoard[k][j].Type) {
                 ++k;
             }
 
@@ -388,77 +516,86 @@ CellDestructionData GameWorld::GetCellsToDestroyFromCurrentState() const
     return CellDestructionData(std::move(cellsToRemove), maxRowStreak, maxColStreak);
 }
 
-void GameWorld::UpdateBoardState(CellDestructionData&& cellDestructionData)
+CellDestructionData GameWorld::GetCellsToDestroyAfterSwitch(Vec2 lhs, Vec2 rhs)
 {
-    const auto& cellsToRemove = cellDestructionData.DestroyedCells;
-    if (!cellsToRemove.empty()) {
-        for (auto& cell : cellsToRemove) {
-            At(cell).Destroy();
-        }
+    auto tmp = At(lhs);
+    At(lhs) = At(rhs);
+    At(rhs) = tmp;
 
-        _gameState->UpdateScore(cellDestructionData);
+    // Check if we can destroy something in the new state
+    auto cellsToDestroy = GetCellsToDestroyFromCurrentState(true);
 
-        DestroyCellsAnimated(std::move(cellDestructionData.DestroyedCells), CellDestroyAnimationDurationMs, [this]() { MoveDownCells(); });
-    }
-}
-
-void GameWorld::UpdateBoardState()
-{
-    auto cellsToRemove = GetCellsToDestroyFromCurrentState();
+    // Restore the original state
+    tmp = At(lhs);
+    At(lhs) = At(rhs);
+    At(rhs) = tmp;
 
-    UpdateBoardState(std::move(cellsToRemove));
+    return cellsToDestroy;
 }
 
-void GameWorld::MoveCellsAnimated(
-    std::vector<CellAnimationMoveData>&& moveData,
+GameWorld::AnimationAwaiter GameWorld::MoveCellsAnimated(
+    std::span<const CellAnimationMoveData> moveData,
     double animationDuration,
-    std::function<void()> completion,
     EasingFunction easingFun)
 {
-    assert(!_animationState);
-    _animationState.emplace();
+    auto& animation = _animations.Start(GetScaledDuration(AnimationCategory::Switch, animationDuration), easingFun).Data;
+    animation.Moves.assign(moveData.begin(), moveData.end());
+    animation.ControlledCells.clear();
 
-    for (auto& animationData : moveData) {
+    for (auto& animationData : animation.Moves) {
         auto& finalCell = At(animationData.FinalPosition);
+        // A cell can only be controlled by one track at a time
+        assert(finalCell.State != Cell::CellState::WaitingForAnimationToComplete);
         finalCell.State = Cell::CellState::WaitingForAnimationToComplete;
         finalCell.Type = animationData.CellType;
+        animation.ControlledCells.push_back(animationData.FinalPosition);
 
         animationData.FinalPosition = animationData.FinalPosition * TileSize;
         animationData.StartingPosition = animationData.StartPositionOverride.value_or(animationData.StartingPosition) * TileSize;
     }
 
-    _animationState->AnimationData = std::move(moveData);
+    animation.Destructions.clear();
+    animation.Continuation = nullptr;
+    animation.FinalCellState = Cell::CellState::Normal;
 
-    _animationState->AnimationDuration = animationDuration;
-    _animationState->Completion = std::move(completion);
-    _animationState->EasingFun = easingFun;
+    return AnimationAwaiter { animation };
 }
 
-void GameWorld::DestroyCellsAnimated(std::vector<Vec2>&& cellsToDestroy, double animationTime, std::function<void()> completion)
+GameWorld::AnimationAwaiter GameWorld::DestroyCellsAnimated(std::span<const Vec2> cellsToDestroy, double animationTime)
 {
-    _animationState.emplace();
+    auto& animation = _animations.Start(GetScaledDuration(AnimationCategory::Destroy, animationTime), EasingFunction::EaseInCubic).Data;
 
-    std::vector<CellAnimationDestructionData> animationData;
-    animationData.reserve(cellsToDestroy.size());
+    animation.Moves.clear();
+    animation.Destructions.clear();
+    animation.ControlledCells.clear();
 
     for (Vec2 cell : cellsToDestroy) {
-        animationData.push_back(CellAnimationDestructionData { cell, At(cell).Type });
+        assert(At(cell).State != Cell::CellState::WaitingForAnimationToComplete);
+        animation.Destructions.push_back(CellAnimationDestructionData { cell, At(cell).Type });
+        animation.ControlledCells.push_back(cell);
+
+        _particles.SpawnBurst(cell * TileSize + Vec2 { TileSize / 2, TileSize / 2 }, _screen->GetCellColor(At(cell).Type), ParticlesPerDestroyedCell);
+
+        At(cell).State = Cell::CellState::WaitingForAnimationToComplete;
     }
 
-    _animationState->AnimationData = std::move(animationData);
+    animation.Continuation = nullptr;
+    animation.FinalCellState = Cell::CellState::Destroyed;
+
+    _audioPlayer->PlaySoundEffect(AudioPlayer::SoundEffect::TileDisappear);
 
-    _animationState->AnimationDuration = CellDestroyAnimationDurationMs;
-    _animationState->Completion = std::move(completion);
-    _animationState->FinalCellState = Cell::CellState::Destroyed;
-    _animationState->EffectToPlay = AudioPlayer::SoundEffect::TileDisappear;
+    return AnimationAwaiter { animation };
 }
 
 void GameWorld::MoveDownCells()
 {
-    std::vector<CellAnimationMoveData> cellMoveData;
-
-    // Update the position of every cell that is above a destroyed cell and add them to be animated
+    // Update the position of every cell that is above a destroyed cell and let them fall
     for (int i = 0; i < ColCount; ++i) {
+        // The column is filled once its cells stopped moving
+        if (!IsColumnSettled(i)) {
+            continue;
+        }
+
         int destroyedCellCount = 0;
 
         for (int j = RowCount - 1; j >= 0; --j) {
@@ -466,31 +603,60 @@ void GameWorld::MoveDownCells()
                 ++destroyedCellCount;
             } else if (destroyedCellCount > 0) {
                 int newRow = j + destroyedCellCount;
+                auto cellType = _gameBoard[i][j].Type;
 
-                auto startPosition = Vec2 { i, j };
-                auto finalPosition = Vec2 { i, newRow };
-
-                cellMoveData.push_back(CellAnimationMoveData { startPosition, finalPosition, At(startPosition).Type });
+                // The rows below were already processed, so the final position can be updated right away
+                _gameBoard[i][j].State = Cell::CellState::Destroyed;
+                _gameBoard[i][newRow].Type = cellType;
+                _gameBoard[i][newRow].State = Cell::CellState::WaitingForAnimationToComplete;
 
-                At(startPosition).State = Cell::CellState::Destroyed;
+                _fallSimulator.Add(i, j, newRow, cellType);
             }
         }
 
-        // Fill the board again by generating destroyedCellCount number of new cells and animate them in from the top
+        // Fill the board again by generating destroyedCellCount number of new cells and let them fall in from the top
         for (int cellInd = 0; cellInd < destroyedCellCount; ++cellInd) {
-            auto finalPosition = Vec2 { i, cellInd };
-            auto startPosition = Vec2 { i, cellInd - destroyedCellCount };
             auto newCellType = GetRandomNumber();
 
-            cellMoveData.push_back(CellAnimationMoveData { startPosition, finalPosition, newCellType });
+            _gameBoard[i][cellInd].Type = newCellType;
+            _gameBoard[i][cellInd].State = Cell::CellState::WaitingForAnimationToComplete;
+
+            _fallSimulator.Add(i, cellInd - destroyedCellCount, cellInd, newCellType);
         }
     }
+}
 
-    MoveCellsAnimated(
-        std::move(cellMoveData),
-        BaseCellFallAnimationDurationMs,
-        [this]() { UpdateBoardState(); },
-        EasingFunction::EaseOutBounce);
+Task GameWorld::RunCascade()
+{
+    while (true) {
+        MoveDownCells();
+
+        auto cellsToDestroy = GetCellsToDestroyFromCurrentState();
+        if (cellsToDestroy.DestroyedCells.empty()) {
+            co_return;
+        }
+
+        _gameState->UpdateScore(cellsToDestroy);
+
+        co_await DestroyCellsAnimated(cellsToDestroy.DestroyedCells, CellDestroyAnimationDurationMs);
+    }
+}
+
+Task GameWorld::MoveCellsAndRunCascade(CellAnimationMoveData move, std::optional<CellAnimationMoveData> otherMove)
+{
+    // The second slot is only read if there is another move
+    std::array<CellAnimationMoveData, 2> moves { move, otherMove.value_or(move) };
+    co_await MoveCellsAnimated(std::span(moves.data(), otherMove ? 2 : 1), CellSwitchAnimationDurationMs);
+    co_await RunCascade();
+}
+
+void GameWorld::Spawn(Task task)
+{
+    task.Start();
+
+    if (!task.IsDone()) {
+        _tasks.push_back(std::move(task));
+    }
 }
 
 bool GameWorld::IsIndexOnTheBoard(Vec2 index) const
@@ -498,6 +664,13 @@ bool GameWorld::IsIndexOnTheBoard(Vec2 index) const
     return !(index.x < 0 || index.x > ColCount - 1 || index.y < 0 || index.y > RowCount - 1);
 }
 
+bool GameWorld::IsColumnSettled(int column) const
+{
+    return std::none_of(_gameBoard[column].begin(), _gameBoard[column].end(), [](const Cell& cell) {
+        return cell.State == Cell::CellState::WaitingForAnimationToComplete || cell.State == Cell::CellState::Active;
+    });
+}
+
 CellDestructionData::CellDestructionData(std::vector<Vec2>&& destroyedCells, int highestRowCombo, int highestColCombo)
     : DestroyedCells(std::move(destroyedCells))
     , HighestRowCombo(highestRowCombo)
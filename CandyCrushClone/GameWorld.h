@@ -1,15 +1,21 @@
 #pragma once
 
+#include "AnimationPool.h"
+#include "AnimationSpeed.h"
 #include "AudioPlayer.h"
+#include "DrawList.h"
 #include "Event.h"
+#include "FallSimulator.h"
 #include "GameState.h"
+#include "ParticleSystem.h"
 #include "Screen.h"
+#include "Task.h"
 #include "Vec2.h"
 
 #include <array>
 #include <optional>
 #include <random>
-#include <variant>
+#include <span>
 #include <vector>
 
 struct Cell {
@@ -22,8 +28,6 @@ struct Cell {
 
     Cell(int cellTypeId);
 
-    void Destroy();
-
     int Type = -1;
     CellState State = CellState::Normal;
 };
@@ -42,29 +46,49 @@ public:
 
     const int RowCount, ColCount, TileKindCount;
 
-    Event<std::function<void(Vec2 source)>> TileDragCompleted;
+    // isSwitched is false if the switch was not valid and the cell was moved back
+    Event<void(Vec2 source, bool isSwitched)> TileDragCompleted;
 
-    GameWorld(int rowCount, int colCount, int tileKindCount, Screen& screen, AudioPlayer& audioPlayer);
+    GameWorld(int rowCount, int colCount, int tileKindCount, Screen& screen, AudioPlayer& audioPlayer, unsigned int randomSeed);
 
     void Activate(IGameState& gameState);
     void Deactivate();
+    // Destroys the running cascades and the animations they wait for. The coroutine frames have to be freed on the
+    // thread that started them, so call it on the simulation thread before it exits
+    void CancelTasks();
 
-    void Draw();
+    // The animations are drawn between their states before and after the last update, see Game::RunMainLoop
+    void Draw(DrawList& drawList, float interpolationAlpha = 1.0f);
     void Update(uint64_t deltaTimeMs);
+    // Returns true if the next frame would look different from the last drawn one
+    bool NeedsRedraw();
+    // Returns false while the world is not active. Individual cells can still be busy, see IsCellInteractable
     bool IsInteractionEnabled() const;
+    // Only the cells that are not animating can be selected and switched
+    bool IsCellInteractable(Vec2 index) const;
+
+    void SetAnimationSpeed(const AnimationSpeed& speed);
+    const AnimationSpeed& GetAnimationSpeed() const;
 
     void SetActiveCell(std::optional<Vec2> index, Vec2 offset = Vec2 { 0, 0 });
+    // Only moves the drawn active cell, the switches and the drops use the offset of SetActiveCell. The prediction is
+    // dropped after durationMs, if no newer one replaced it the cursor has most likely stopped
+    void SetActiveCellPrediction(Vec2 predictedOffset, uint64_t durationMs);
+    // The offset of SetActiveCell, optionally with the prediction it is drawn with
+    std::optional<Vec2> GetActiveCellOffset(bool isPredictionIncluded) const;
 
     bool TrySwitchCells(Vec2 source, Vec2 destination, bool isDraggedCellTheSource = false);
+    // Switches the dragged cell with its neighbor in the given direction before it is dragged past the threshold.
+    // Unlike at the threshold, a switch that wouldn't destroy anything is not tried, so the drag goes on
+    bool TrySwitchActiveCell(Vec2 direction);
+    // Returns 2 neighboring cells that would destroy some cells if they were switched
+    std::optional<std::pair<Vec2, Vec2>> FindValidSwitch();
 
     std::optional<Vec2> GetTileIndicesAtPoint(Vec2 position);
+    // In screen coordinates
+    Vec2 GetCellCenter(Vec2 index) const;
 
 private:
-    enum class EasingFunction {
-        EaseOutBounce,
-        EaseInCubic,
-    };
-
     struct CellAnimationMoveData {
         Vec2 StartingPosition;
         Vec2 FinalPosition;
@@ -77,28 +101,50 @@ private:
         int CellType;
     };
 
-    struct AnimationState {
-        std::variant<std::vector<CellAnimationMoveData>, std::vector<CellAnimationDestructionData>> AnimationData;
-        std::function<void()> Completion;
-        uint64_t AnimationTimePassed = 0;
-        double AnimationDuration = 0;
-        double AnimationProgress = 0.0;
+    // The data of an animation track. Only one of the vectors is used, both are kept so their capacity can be reused
+    struct CellAnimation {
+        std::vector<CellAnimationMoveData> Moves;
+        std::vector<CellAnimationDestructionData> Destructions;
+        // The cells that are WaitingForAnimationToComplete until the track finishes
+        std::vector<Vec2> ControlledCells;
+        // The coroutine that awaits the track, resumed when it finishes
+        std::coroutine_handle<> Continuation;
         Cell::CellState FinalCellState = Cell::CellState::Normal;
-        EasingFunction EasingFun = EasingFunction::EaseInCubic;
-        std::optional<AudioPlayer::SoundEffect> EffectToPlay;
+    };
+
+    // Returned when a track is started, awaiting it suspends the coroutine until the track finishes
+    struct AnimationAwaiter {
+        CellAnimation& Animation;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            Animation.Continuation = awaiting;
+        }
+
+        void await_resume() noexcept { }
     };
 
     struct ActiveCellState {
         Vec2 Index;
         Vec2 Offset;
         uint64_t AnimationTimePassed = 0;
+        Vec2 PredictedOffset { 0, 0 };
+        uint64_t PredictionTimeLeftMs = 0;
     };
 
     static constexpr int TileSize = 70; // The provided assets have this size, so for now just use it
     static constexpr int DragOffsetSuccessThreshold = int(TileSize * 0.8);
     static constexpr double CellSwitchAnimationDurationMs = 200.0;
     static constexpr double CellDestroyAnimationDurationMs = 400.0;
-    static constexpr double BaseCellFallAnimationDurationMs = 800.0;
+    static constexpr int ParticlesPerDestroyedCell = 60;
+    // In instant mode the animations are played to their end in steps of this size
+    static constexpr uint64_t InstantModeStepMs = 1000;
+    static constexpr int MaxInstantModeSteps = 100;
 
     Cell& At(Vec2 indices);
     const Cell& At(Vec2 indices) const;
@@ -107,30 +153,54 @@ private:
     Cell GenerateCellForIndex(int i, int j);
     void FillBoard();
 
-    CellDestructionData GetCellsToDestroyFromCurrentState() const;
-    void UpdateBoardState();
-    void UpdateBoardState(CellDestructionData&& cellsToRemove);
-    void MoveCellsAnimated(
-        std::vector<CellAnimationMoveData>&& moveData,
+    // Only the cells in the Normal state can be matched. The switch check includes the active cell as well
+    CellDestructionData GetCellsToDestroyFromCurrentState(bool includeActiveCells = false) const;
+    CellDestructionData GetCellsToDestroyAfterSwitch(Vec2 lhs, Vec2 rhs);
+    // The move data is copied into the pooled track, so its capacity is reused
+    AnimationAwaiter MoveCellsAnimated(
+        std::span<const CellAnimationMoveData> moveData,
         double animationDuration,
-        std::function<void()> completion,
         EasingFunction easingFun = EasingFunction::EaseInCubic);
-    void DestroyCellsAnimated(std::vector<Vec2>&& cellsToDestroy, double animationTime, std::function<void()> completion);
+    AnimationAwaiter DestroyCellsAnimated(std::span<const Vec2> cellsToDestroy, double animationTime);
+    // Lets the cells above the destroyed ones fall into the settled columns and generates new cells above them
     void MoveDownCells();
 
+    // Fills the holes and destroys the matches in the parts of the board that are not animating, until there is
+    // nothing left to destroy. The cells that are still falling start another cascade when they land
+    Task RunCascade();
+    // The player moves at most 2 cells at once. They are kept in the pooled coroutine frame instead of a vector
+    Task MoveCellsAndRunCascade(CellAnimationMoveData move, std::optional<CellAnimationMoveData> otherMove = std::nullopt);
+    // Starts the task, which is kept alive until it finishes
+    void Spawn(Task task);
+
+    // Advances the cell animations and the falling cells, which resumes the cascades waiting for them
+    void UpdateBoardAnimations(uint64_t deltaTimeMs);
+    bool IsBoardAnimating() const;
+    double GetScaledDuration(AnimationCategory category, double durationMs) const;
+    std::optional<std::string> GetAnimationSpeedText() const;
+
     bool IsIndexOnTheBoard(Vec2 index) const;
+    bool TrySwitchDraggedCell(Vec2 index, Vec2 direction);
+    // A column is settled if none of its cells are animating or held by the player
+    bool IsColumnSettled(int column) const;
 
     // The board is stored in a column major order. Columns are growing from left to right. Rows are growing from top to bottom.
     GameBoard _gameBoard;
     Screen* _screen = nullptr;
     bool _isActive = false;
+    bool _needsRedraw = true;
+    std::vector<std::string> _lastDrawnUIText;
 
-    std::random_device _randomDevice;
     std::mt19937 _randomEngine;
     std::uniform_int_distribution<int> _randomDistribution;
 
-    std::optional<AnimationState> _animationState;
+    AnimationPool<CellAnimation> _animations;
     std::optional<ActiveCellState> _activeCellState;
     IGameState* _gameState;
     AudioPlayer* _audioPlayer;
+    FallSimulator _fallSimulator;
+    ParticleSystem _particles;
+    // The running cascades, they are suspended while their animations play
+    std::vector<Task> _tasks;
+    AnimationSpeed _animationSpeed;
 };
@@ -0,0 +1,66 @@
+#include "HitTestGrid.h"
+
+#include <algorithm>
+
+namespace {
+bool Contains(const SDL_Rect& rect, Vec2 position)
+{
+    return position.x >= rect.x && position.y >= rect.y && position.x <= rect.x + rect.w && position.y <= rect.y + rect.h;
+}
+}
+
+HitTestGrid::HitTestGrid(int width, int height, int cellSize)
+    : _cellSize(cellSize)
+    , _columnCount((width + cellSize) / cellSize)
+    , _rowCount((height + cellSize) / cellSize)
+    , _cells(size_t(_columnCount) * _rowCount)
+{
+}
+
+void HitTestGrid::Clear()
+{
+    for (auto& cell : _cells) {
+        cell.clear();
+    }
+}
+
+void HitTestGrid::Insert(const SDL_Rect& rect, int id)
+{
+    auto firstColumn = std::max(rect.x / _cellSize, 0);
+    auto lastColumn = std::min((rect.x + rect.w) / _cellSize, _columnCount - 1);
+    auto firstRow = std::max(rect.y / _cellSize, 0);
+    auto lastRow = std::min((rect.y + rect.h) / _cellSize, _rowCount - 1);
+
+    for (int column = firstColumn; column <= lastColumn; ++column) {
+        for (int row = firstRow; row <= lastRow; ++row) {
+            _cells[GetCellIndex(column, row)].push_back(Entry { rect, id });
+        }
+    }
+}
+
+std::optional<int> HitTestGrid::Find(Vec2 position) const
+{
+    if (position.x < 0 || position.y < 0) {
+        return std::nullopt;
+    }
+
+    auto column = position.x / _cellSize;
+    auto row = position.y / _cellSize;
+    if (column >= _columnCount || row >= _rowCount) {
+        return std::nullopt;
+    }
+
+    const auto& cell = _cells[GetCellIndex(column, row)];
+    for (auto it = cell.rbegin(); it != cell.rend(); ++it) {
+        if (Contains(it->Rect, position)) {
+            return it->Id;
+        }
+    }
+
+    return std::nullopt;
+}
+
+int HitTestGrid::GetCellIndex(int column, int row) const
+{
+    return row * _columnCount + column;
+}
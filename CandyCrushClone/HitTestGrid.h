@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Vec2.h"
+
+#include <SDL.h>
+
+#include <optional>
+#include <vector>
+
+// Finds the rectangle under a point without checking all of them. The area is divided into square cells and every
+// cell lists the rectangles overlapping it, so a lookup only checks the rectangles of one cell. The rectangles
+// contain their right and bottom edges too, like the buttons of the menu
+class HitTestGrid {
+public:
+    HitTestGrid(int width, int height, int cellSize);
+
+    // The capacity of the cells is kept, so rebuilding the index after a layout change doesn't allocate
+    void Clear();
+    // The id is returned by Find. The parts outside of the area are ignored
+    void Insert(const SDL_Rect& rect, int id);
+    // If more rectangles contain the position, the one inserted last is returned
+    std::optional<int> Find(Vec2 position) const;
+
+private:
+    struct Entry {
+        SDL_Rect Rect;
+        int Id;
+    };
+
+    int GetCellIndex(int column, int row) const;
+
+    int _cellSize;
+    int _columnCount;
+    int _rowCount;
+    std::vector<std::vector<Entry>> _cells;
+};
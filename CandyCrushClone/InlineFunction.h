@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <class Signature, size_t Capacity = 32>
+class InlineFunction;
+
+// A move-only std::function replacement that stores the callable in an inline buffer, so it never allocates.
+// A callable that doesn't fit into Capacity bytes is a compile error
+template <class R, class... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+public:
+    InlineFunction() = default;
+    InlineFunction(std::nullptr_t) { }
+
+    template <class F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, InlineFunction> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+    InlineFunction(F&& function)
+    {
+        using Stored = std::decay_t<F>;
+        static_assert(sizeof(Stored) <= Capacity, "The callable doesn't fit into the inline buffer");
+        static_assert(alignof(Stored) <= alignof(std::max_align_t));
+        static_assert(std::is_nothrow_move_constructible_v<Stored>);
+
+        new (_storage) Stored(std::forward<F>(function));
+        _invoke = [](void* storage, Args... args) -> R {
+            return (*static_cast<Stored*>(storage))(std::forward<Args>(args)...);
+        };
+        _relocate = [](void* destination, void* source) {
+            auto* stored = static_cast<Stored*>(source);
+            if (destination) {
+                new (destination) Stored(std::move(*stored));
+            }
+            stored->~Stored();
+        };
+    }
+
+    InlineFunction(InlineFunction&& other) noexcept
+    {
+        MoveFrom(other);
+    }
+
+    InlineFunction& operator=(InlineFunction&& other) noexcept
+    {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+
+        return *this;
+    }
+
+    InlineFunction& operator=(std::nullptr_t)
+    {
+        Reset();
+        return *this;
+    }
+
+    InlineFunction(const InlineFunction&) = delete;
+    InlineFunction& operator=(const InlineFunction&) = delete;
+
+    ~InlineFunction()
+    {
+        Reset();
+    }
+
+    explicit operator bool() const
+    {
+        return _invoke != nullptr;
+    }
+
+    R operator()(Args... args) const
+    {
+        assert(_invoke);
+        return _invoke(_storage, std::forward<Args>(args)...);
+    }
+
+private:
+    alignas(std::max_align_t) mutable std::byte _storage[Capacity];
+    R (*_invoke)(void* storage, Args... args) = nullptr;
+    // Moves the callable from source to destination and destroys the source. A null destination only destroys it
+    void (*_relocate)(void* destination, void* source) = nullptr;
+
+    void MoveFrom(InlineFunction& other)
+    {
+        if (other._invoke) {
+            other._relocate(_storage, other._storage);
+            _invoke = std::exchange(other._invoke, nullptr);
+            _relocate = std::exchange(other._relocate, nullptr);
+        }
+    }
+
+    void Reset()
+    {
+        if (_invoke) {
+            _relocate(nullptr, _storage);
+            _invoke = nullptr;
+            _relocate = nullptr;
+        }
+    }
+};
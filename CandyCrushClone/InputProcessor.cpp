@@ -1,16 +1,44 @@
 #include "InputProcessor.h"
 
+#include <algorithm>
+
 namespace {
 constexpr float mouseDragThresholdSquared = 4;
 }
 
+const char* GetInputEventKindName(InputEventKind kind)
+{
+    switch (kind) {
+    case InputEventKind::MouseDragStarted:
+        return "drag start";
+    case InputEventKind::MouseDragMoved:
+        return "drag move";
+    case InputEventKind::MouseDragEnded:
+        return "drag end";
+    case InputEventKind::MouseClicked:
+        return "click";
+    case InputEventKind::MouseMoved:
+        return "mouse move";
+    case InputEventKind::KeyPressed:
+        return "key press";
+    default:
+        return "unknown";
+    }
+}
+
 void InputProcessor::ProcessKeyEvent(const SDL_Event& keyEvent)
 {
     assert(keyEvent.type == SDL_KEYDOWN);
 
     switch (keyEvent.key.keysym.sym) {
     case SDLK_ESCAPE: {
-        KeyPressed.Invoke(Key::Escape);
+        Enqueue(QueuedEvent { InputEventKind::KeyPressed, keyEvent.key.timestamp, {}, keyEvent.key.timestamp, Key::Escape });
+    } break;
+    case SDLK_s: {
+        Enqueue(QueuedEvent { InputEventKind::KeyPressed, keyEvent.key.timestamp, {}, keyEvent.key.timestamp, Key::CycleAnimationSpeed });
+    } break;
+    case SDLK_l: {
+        Enqueue(QueuedEvent { InputEventKind::KeyPressed, keyEvent.key.timestamp, {}, keyEvent.key.timestamp, Key::ToggleLatencyOverlay });
     } break;
     }
 }
@@ -27,26 +55,26 @@ void InputProcessor::ProcessMouseEvent(const SDL_Event& mouseEvent)
         if (mouseEvent.button.button == SDL_BUTTON_LEFT) {
             if (_mouseDragStartPosition) {
                 if (_isDragging) {
-                    MouseDragMoved.Invoke(Vec2 { mouseEvent.button.x, mouseEvent.button.y });
+                    Enqueue(QueuedEvent { InputEventKind::MouseDragMoved, mouseEvent.common.timestamp, Vec2 { mouseEvent.button.x, mouseEvent.button.y }, mouseEvent.common.timestamp });
                 } else if (_mouseDragStartPosition->DistanceSquared(Vec2 { mouseEvent.button.x, mouseEvent.button.y }) > mouseDragThresholdSquared) {
                     // If we are not yet dragging and the drag can be started, then let's start it
                     _isDragging = true;
-                    MouseDragStarted.Invoke(*_mouseDragStartPosition);
+                    Enqueue(QueuedEvent { InputEventKind::MouseDragStarted, mouseEvent.common.timestamp, *_mouseDragStartPosition, mouseEvent.common.timestamp });
                 }
             }
         }
 
-        MouseMoved.Invoke(Vec2 { mouseEvent.button.x, mouseEvent.button.y });
+        Enqueue(QueuedEvent { InputEventKind::MouseMoved, mouseEvent.common.timestamp, Vec2 { mouseEvent.button.x, mouseEvent.button.y }, mouseEvent.common.timestamp });
     } break;
     case SDL_MOUSEBUTTONUP: {
         if (mouseEvent.button.button == SDL_BUTTON_LEFT) {
             if (_mouseDragStartPosition) {
                 if (_isDragging) {
-                    MouseDragEnded.Invoke(Vec2 { mouseEvent.button.x, mouseEvent.button.y });
+                    Enqueue(QueuedEvent { InputEventKind::MouseDragEnded, mouseEvent.common.timestamp, Vec2 { mouseEvent.button.x, mouseEvent.button.y }, mouseEvent.common.timestamp });
                     _isDragging = false;
                 } else {
                     // Instead of the start position (mouse down even location), we invoke the event with the current position. Should be less confusing
-                    MouseClicked.Invoke(Vec2 { mouseEvent.button.x, mouseEvent.button.y });
+                    Enqueue(QueuedEvent { InputEventKind::MouseClicked, mouseEvent.common.timestamp, Vec2 { mouseEvent.button.x, mouseEvent.button.y }, mouseEvent.common.timestamp });
                 }
 
                 _mouseDragStartPosition.reset();
@@ -57,3 +85,142 @@ void InputProcessor::ProcessMouseEvent(const SDL_Event& mouseEvent)
         break;
     }
 }
+
+void InputProcessor::DispatchQueuedEvents()
+{
+    _lastDispatchStats = InputDispatchStats { _receivedEventCount, uint32_t(_queuedEvents.size()), 0 };
+
+    for (size_t i = 0; i < _queuedEvents.size(); ++i) {
+        const auto& event = _queuedEvents[i];
+        _currentEventIndex = i;
+        _isCurrentEventVisible = false;
+
+        auto invoke = [this](auto& eventToInvoke, const auto& value) {
+            _lastDispatchStats.HandlerCallCount += uint32_t(eventToInvoke.GetSubscriberCount());
+            eventToInvoke.Invoke(value);
+        };
+
+        switch (event.Kind) {
+        case InputEventKind::MouseDragStarted: {
+            invoke(MouseDragStarted, event.Position);
+        } break;
+        case InputEventKind::MouseDragMoved: {
+            invoke(MouseDragMoved, event.Position);
+        } break;
+        case InputEventKind::MouseDragEnded: {
+            invoke(MouseDragEnded, event.Position);
+        } break;
+        case InputEventKind::MouseClicked: {
+            invoke(MouseClicked, event.Position);
+        } break;
+        case InputEventKind::MouseMoved: {
+            invoke(MouseMoved, event.Position);
+        } break;
+        case InputEventKind::KeyPressed: {
+            invoke(KeyPressed, event.PressedKey);
+        } break;
+        }
+    }
+
+    _currentEventIndex = NoQueuedEvent;
+    _queuedEvents.clear();
+    _moveHistory.clear();
+    _lastMouseMovedIndex = NoQueuedEvent;
+    _lastMouseDragMovedIndex = NoQueuedEvent;
+    _receivedEventCount = 0;
+
+    _maxDispatchStats.ReceivedEventCount = std::max(_maxDispatchStats.ReceivedEventCount, _lastDispatchStats.ReceivedEventCount);
+    _maxDispatchStats.DispatchedEventCount = std::max(_maxDispatchStats.DispatchedEventCount, _lastDispatchStats.DispatchedEventCount);
+    _maxDispatchStats.HandlerCallCount = std::max(_maxDispatchStats.HandlerCallCount, _lastDispatchStats.HandlerCallCount);
+}
+
+void InputProcessor::MarkCurrentEventVisible()
+{
+    if (_currentEventIndex == NoQueuedEvent || _isCurrentEventVisible) {
+        return;
+    }
+
+    const auto& event = _queuedEvents[_currentEventIndex];
+    _visibleEvents.push_back(TracedInput { event.Kind, event.TimestampMs });
+    _isCurrentEventVisible = true;
+}
+
+std::span<const TracedInput> InputProcessor::GetVisibleEvents() const
+{
+    return _visibleEvents;
+}
+
+uint32_t InputProcessor::GetCurrentEventPositionTimestamp() const
+{
+    return _currentEventIndex == NoQueuedEvent ? 0 : _queuedEvents[_currentEventIndex].PositionTimestampMs;
+}
+
+std::span<const PositionSample> InputProcessor::GetCurrentEventHistory() const
+{
+    if (_currentEventIndex == NoQueuedEvent) {
+        return {};
+    }
+
+    const auto& event = _queuedEvents[_currentEventIndex];
+    return std::span(_moveHistory).subspan(event.HistoryBegin, event.HistoryEnd - event.HistoryBegin);
+}
+
+void InputProcessor::ClearVisibleEvents()
+{
+    _visibleEvents.clear();
+}
+
+const InputDispatchStats& InputProcessor::GetLastDispatchStats() const
+{
+    return _lastDispatchStats;
+}
+
+const InputDispatchStats& InputProcessor::GetMaxDispatchStats() const
+{
+    return _maxDispatchStats;
+}
+
+size_t InputProcessor::GetSubscriberCount() const
+{
+    return MouseDragStarted.GetSubscriberCount() + MouseDragMoved.GetSubscriberCount() + MouseDragEnded.GetSubscriberCount()
+        + MouseClicked.GetSubscriberCount() + MouseMoved.GetSubscriberCount() + KeyPressed.GetSubscriberCount();
+}
+
+void InputProcessor::Enqueue(QueuedEvent event)
+{
+    ++_receivedEventCount;
+
+    switch (event.Kind) {
+    case InputEventKind::MouseMoved: {
+        if (_lastMouseMovedIndex != NoQueuedEvent) {
+            _queuedEvents[_lastMouseMovedIndex].Position = event.Position;
+            _queuedEvents[_lastMouseMovedIndex].PositionTimestampMs = event.PositionTimestampMs;
+            return;
+        }
+
+        _lastMouseMovedIndex = _queuedEvents.size();
+    } break;
+    case InputEventKind::MouseDragMoved: {
+        _moveHistory.push_back(PositionSample { event.Position, event.PositionTimestampMs });
+
+        if (_lastMouseDragMovedIndex != NoQueuedEvent) {
+            auto& queuedEvent = _queuedEvents[_lastMouseDragMovedIndex];
+            queuedEvent.Position = event.Position;
+            queuedEvent.PositionTimestampMs = event.PositionTimestampMs;
+            queuedEvent.HistoryEnd = _moveHistory.size();
+            return;
+        }
+
+        _lastMouseDragMovedIndex = _queuedEvents.size();
+        event.HistoryBegin = _moveHistory.size() - 1;
+        event.HistoryEnd = _moveHistory.size();
+    } break;
+    default: {
+        // The moves before this one have to be delivered before it, so they can't be replaced anymore
+        _lastMouseMovedIndex = NoQueuedEvent;
+        _lastMouseDragMovedIndex = NoQueuedEvent;
+    } break;
+    }
+
+    _queuedEvents.push_back(event);
+}
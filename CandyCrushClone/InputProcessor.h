@@ -5,26 +5,120 @@
 
 #include <SDL.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <span>
+#include <vector>
 
 enum class Key {
     Escape,
+    CycleAnimationSpeed,
+    ToggleLatencyOverlay,
 };
 
+enum class InputEventKind {
+    MouseDragStarted,
+    MouseDragMoved,
+    MouseDragEnded,
+    MouseClicked,
+    MouseMoved,
+    KeyPressed,
+};
+
+// Kept outside of the enum, so the switches over the kinds don't need a case for it
+static constexpr size_t InputEventKindCount = size_t(InputEventKind::KeyPressed) + 1;
+
+const char* GetInputEventKindName(InputEventKind kind);
+
+// A dispatched event whose handlers changed what is drawn, see InputProcessor::MarkCurrentEventVisible
+struct TracedInput {
+    InputEventKind Kind;
+    uint32_t TimestampMs; // The SDL timestamp of the event, comparable to SDL_GetTicks
+};
+
+// A position of a move, the coalesced moves keep all of theirs
+struct PositionSample {
+    Vec2 Position;
+    uint32_t TimestampMs;
+};
+
+// The number of events and handler calls of a dispatch
+struct InputDispatchStats {
+    uint32_t ReceivedEventCount = 0; // The events that were queued, including the coalesced ones
+    uint32_t DispatchedEventCount = 0;
+    uint32_t HandlerCallCount = 0;
+};
+
+// Turns the SDL events into higher level events. They are queued and only invoked by DispatchQueuedEvents, which the
+// game calls once per frame. A move replaces the previous move of the same kind if nothing else was queued since then,
+// so a high polling rate mouse can't flood the handlers, but the order of the presses, clicks and drags is kept.
+// The drag handlers can still read every position of a coalesced drag move, see GetCurrentEventHistory
 class InputProcessor {
 public:
     void ProcessKeyEvent(const SDL_Event& keyEvent);
     void ProcessMouseEvent(const SDL_Event& mouseEvent);
+    void DispatchQueuedEvents();
+
+    // The handlers call this when the event they handle changes what is drawn. The event is kept until the game
+    // records the next frame, which is the first one showing its effect
+    void MarkCurrentEventVisible();
+    std::span<const TracedInput> GetVisibleEvents() const;
+    // The SDL timestamp of the position of the event whose handlers are running, the newest one for a coalesced move
+    uint32_t GetCurrentEventPositionTimestamp() const;
+    // The positions of the drag move whose handlers are running, in order, including the ones of the coalesced moves.
+    // The last one is the position passed to the handlers. Empty for the other events
+    std::span<const PositionSample> GetCurrentEventHistory() const;
+    void ClearVisibleEvents();
+
+    const InputDispatchStats& GetLastDispatchStats() const;
+    // The highest values of a single dispatch
+    const InputDispatchStats& GetMaxDispatchStats() const;
+    // The handlers subscribed to all of the events
+    size_t GetSubscriberCount() const;
 
-    Event<std::function<void(Vec2 position)>> MouseDragStarted;
-    Event<std::function<void(Vec2 position)>> MouseDragMoved;
-    Event<std::function<void(Vec2 position)>> MouseDragEnded;
-    Event<std::function<void(Vec2 position)>> MouseClicked;
-    Event<std::function<void(Vec2 position)>> MouseMoved;
+    Event<void(Vec2 position)> MouseDragStarted;
+    Event<void(Vec2 position)> MouseDragMoved;
+    Event<void(Vec2 position)> MouseDragEnded;
+    Event<void(Vec2 position)> MouseClicked;
+    Event<void(Vec2 position)> MouseMoved;
 
-    Event<std::function<void(Key key)>> KeyPressed;
+    Event<void(Key key)> KeyPressed;
 
 private:
+    struct QueuedEvent {
+        InputEventKind Kind;
+        // A coalesced move keeps the timestamp of the first move it replaced, so the latency includes the coalescing
+        uint32_t TimestampMs = 0;
+        Vec2 Position {};
+        uint32_t PositionTimestampMs = 0;
+        Key PressedKey = Key::Escape;
+        // The range of the positions of a drag move in _moveHistory
+        size_t HistoryBegin = 0;
+        size_t HistoryEnd = 0;
+    };
+
+    static constexpr size_t NoQueuedEvent = SIZE_MAX;
+
     bool _isDragging = false;
     std::optional<Vec2> _mouseDragStartPosition;
+
+    std::vector<QueuedEvent> _queuedEvents;
+    // The indices of the moves that can still be replaced by a newer move
+    size_t _lastMouseMovedIndex = NoQueuedEvent;
+    size_t _lastMouseDragMovedIndex = NoQueuedEvent;
+    uint32_t _receivedEventCount = 0;
+    // Only the drag moves add to it, and a drag move can only be coalesced until another event is queued, so the
+    // positions of a queued drag move are always next to each other
+    std::vector<PositionSample> _moveHistory;
+
+    // The index of the event whose handlers are running, and whether it was already marked visible
+    size_t _currentEventIndex = NoQueuedEvent;
+    bool _isCurrentEventVisible = false;
+    std::vector<TracedInput> _visibleEvents;
+
+    InputDispatchStats _lastDispatchStats;
+    InputDispatchStats _maxDispatchStats;
+
+    void Enqueue(QueuedEvent event);
 };
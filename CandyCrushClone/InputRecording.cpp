@@ -0,0 +1,229 @@
+#include "InputRecording.h"
+
+#include <array>
+#include <iostream>
+
+namespace {
+static constexpr std::array<char, 4> FileMagic { 'C', 'C', 'I', 'R' };
+static constexpr uint32_t FileVersion = 1;
+
+enum class RecordedEventType : uint8_t {
+    Quit,
+    Window,
+    MouseMotion,
+    MouseButtonDown,
+    MouseButtonUp,
+    KeyDown,
+};
+
+struct EventRecord {
+    RecordedEventType Type;
+    uint8_t Button;
+    int16_t X;
+    int16_t Y;
+    int32_t TimestampOffsetMs;
+    int32_t KeySymbol;
+};
+
+std::optional<RecordedEventType> GetRecordedEventType(uint32_t sdlEventType)
+{
+    switch (sdlEventType) {
+    case SDL_QUIT:
+        return RecordedEventType::Quit;
+    case SDL_WINDOWEVENT:
+        return RecordedEventType::Window;
+    case SDL_MOUSEMOTION:
+        return RecordedEventType::MouseMotion;
+    case SDL_MOUSEBUTTONDOWN:
+        return RecordedEventType::MouseButtonDown;
+    case SDL_MOUSEBUTTONUP:
+        return RecordedEventType::MouseButtonUp;
+    case SDL_KEYDOWN:
+        return RecordedEventType::KeyDown;
+    default:
+        return std::nullopt;
+    }
+}
+
+uint32_t GetSdlEventType(RecordedEventType type)
+{
+    switch (type) {
+    case RecordedEventType::Quit:
+        return SDL_QUIT;
+    case RecordedEventType::Window:
+        return SDL_WINDOWEVENT;
+    case RecordedEventType::MouseMotion:
+        return SDL_MOUSEMOTION;
+    case RecordedEventType::MouseButtonDown:
+        return SDL_MOUSEBUTTONDOWN;
+    case RecordedEventType::MouseButtonUp:
+        return SDL_MOUSEBUTTONUP;
+    case RecordedEventType::KeyDown:
+        return SDL_KEYDOWN;
+    }
+
+    return SDL_FIRSTEVENT;
+}
+
+template <class T>
+void Write(std::ofstream& file, const T& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+bool Read(std::ifstream& file, T& value)
+{
+    return bool(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void WriteEvent(std::ofstream& file, const SDL_Event& e, RecordedEventType type, uint64_t frameStartMs)
+{
+    // The motion events are read through the button member as well, see InputProcessor::ProcessMouseEvent
+    Write(file, type);
+    Write(file, e.button.button);
+    Write(file, int16_t(e.button.x));
+    Write(file, int16_t(e.button.y));
+    Write(file, int32_t(e.common.timestamp - uint32_t(frameStartMs)));
+    Write(file, int32_t(type == RecordedEventType::KeyDown ? e.key.keysym.sym : 0));
+}
+
+bool ReadEvent(std::ifstream& file, uint64_t frameStartMs, SDL_Event& e)
+{
+    EventRecord record;
+    if (!Read(file, record.Type) || !Read(file, record.Button) || !Read(file, record.X) || !Read(file, record.Y)
+        || !Read(file, record.TimestampOffsetMs) || !Read(file, record.KeySymbol)) {
+        return false;
+    }
+
+    e = SDL_Event {};
+    e.type = GetSdlEventType(record.Type);
+    e.common.timestamp = uint32_t(frameStartMs) + uint32_t(record.TimestampOffsetMs);
+
+    if (record.Type == RecordedEventType::KeyDown) {
+        e.key.keysym.sym = SDL_Keycode(record.KeySymbol);
+    } else if (record.Type != RecordedEventType::Quit && record.Type != RecordedEventType::Window) {
+        e.button.button = record.Button;
+        e.button.x = record.X;
+        e.button.y = record.Y;
+    }
+
+    return true;
+}
+}
+
+std::unique_ptr<InputRecorder> InputRecorder::Create(const std::string& filePath, const RandomSeeds& seeds, const AnimationSpeed& speed)
+{
+    auto recorder = std::make_unique<InputRecorder>();
+    recorder->_file.open(filePath, std::ios::binary);
+    if (!recorder->_file) {
+        std::cerr << "Failed to open " << filePath << " for recording the input" << std::endl;
+        return nullptr;
+    }
+
+    recorder->_file.write(FileMagic.data(), FileMagic.size());
+    Write(recorder->_file, FileVersion);
+    Write(recorder->_file, seeds.World);
+    Write(recorder->_file, seeds.Audio);
+    // Field by field, so the file doesn't depend on the padding of the struct
+    Write(recorder->_file, speed.GlobalScale);
+    Write(recorder->_file, speed.CategoryScales);
+    Write(recorder->_file, uint8_t(speed.IsInstant));
+
+    return recorder;
+}
+
+void InputRecorder::AddEvent(const SDL_Event& e)
+{
+    if (GetRecordedEventType(e.type)) {
+        _frameEvents.push_back(e);
+    }
+}
+
+void InputRecorder::EndFrame(uint64_t frameStartMs, uint64_t deltaTimeMs)
+{
+    Write(_file, uint32_t(deltaTimeMs));
+    Write(_file, uint32_t(_frameEvents.size()));
+
+    for (const auto& e : _frameEvents) {
+        WriteEvent(_file, e, *GetRecordedEventType(e.type), frameStartMs);
+    }
+
+    _frameEvents.clear();
+}
+
+std::optional<InputReplay> InputReplay::Load(const std::string& filePath)
+{
+    std::ifstream file { filePath, std::ios::binary };
+    if (!file) {
+        std::cerr << "Failed to open the input recording " << filePath << std::endl;
+        return std::nullopt;
+    }
+
+    std::array<char, 4> magic {};
+    uint32_t version = 0;
+    uint8_t isInstant = 0;
+    InputReplay replay;
+    if (!file.read(magic.data(), magic.size()) || magic != FileMagic || !Read(file, version) || version != FileVersion
+        || !Read(file, replay._seeds.World) || !Read(file, replay._seeds.Audio) || !Read(file, replay._speed.GlobalScale)
+        || !Read(file, replay._speed.CategoryScales) || !Read(file, isInstant)) {
+        std::cerr << filePath << " is not an input recording of this version" << std::endl;
+        return std::nullopt;
+    }
+
+    replay._speed.IsInstant = isInstant != 0;
+
+    // The timestamps are restored relative to the replayed time, which starts at 0
+    uint64_t frameStartMs = 0;
+    uint32_t deltaTimeMs = 0;
+    while (Read(file, deltaTimeMs)) {
+        uint32_t eventCount = 0;
+        if (!Read(file, eventCount)) {
+            std::cerr << "The input recording " << filePath << " is truncated" << std::endl;
+            return std::nullopt;
+        }
+
+        // The events of a frame are handled at its end, after its frame time passed
+        frameStartMs += deltaTimeMs;
+
+        auto& frame = replay._frames.emplace_back(RecordedFrame { deltaTimeMs, {} });
+        // The count comes from the file, so the events are only stored once they were read. A corrupt count would
+        // allocate the events before the read could fail
+        for (uint32_t i = 0; i < eventCount; ++i) {
+            SDL_Event e;
+            if (!ReadEvent(file, frameStartMs, e)) {
+                std::cerr << "The input recording " << filePath << " is truncated" << std::endl;
+                return std::nullopt;
+            }
+
+            frame.Events.push_back(e);
+        }
+    }
+
+    return replay;
+}
+
+const RandomSeeds& InputReplay::GetSeeds() const
+{
+    return _seeds;
+}
+
+const AnimationSpeed& InputReplay::GetAnimationSpeed() const
+{
+    return _speed;
+}
+
+const std::vector<RecordedFrame>& InputReplay::GetFrames() const
+{
+    return _frames;
+}
+
+size_t InputReplay::GetEventCount() const
+{
+    size_t count = 0;
+    for (const auto& frame : _frames) {
+        count += frame.Events.size();
+    }
+
+    return count;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "AnimationSpeed.h"
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// The seeds of every random engine of the game, recorded with the input so the replay plays the same boards
+struct RandomSeeds {
+    uint32_t World = 0;
+    uint32_t Audio = 0;
+};
+
+// The events handled before an update, and the frame time of the update
+struct RecordedFrame {
+    uint32_t DeltaTimeMs = 0;
+    std::vector<SDL_Event> Events;
+};
+
+// Writes the raw SDL events that the game handles to a binary file, one record per update. Only the fields read by
+// the game are kept, and the event timestamps are stored relative to the start of the frame that handled them.
+// The seeds and the starting animation speed are written first, so the replay plays the same game.
+// The values are written in the byte order of the machine
+class InputRecorder {
+public:
+    // Returns nullptr if the file can't be opened
+    static std::unique_ptr<InputRecorder> Create(const std::string& filePath, const RandomSeeds& seeds, const AnimationSpeed& speed);
+
+    // Events that the game ignores are not recorded
+    void AddEvent(const SDL_Event& e);
+    // Writes the events added since the last call, with the frame time of the update following them
+    void EndFrame(uint64_t frameStartMs, uint64_t deltaTimeMs);
+
+private:
+    std::ofstream _file;
+    std::vector<SDL_Event> _frameEvents;
+};
+
+class InputReplay {
+public:
+    // Returns nullopt if the file can't be read or isn't a recording
+    static std::optional<InputReplay> Load(const std::string& filePath);
+
+    const RandomSeeds& GetSeeds() const;
+    const AnimationSpeed& GetAnimationSpeed() const;
+    const std::vector<RecordedFrame>& GetFrames() const;
+    size_t GetEventCount() const;
+
+private:
+    RandomSeeds _seeds;
+    AnimationSpeed _speed;
+    std::vector<RecordedFrame> _frames;
+};
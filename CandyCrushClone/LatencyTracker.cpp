@@ -0,0 +1,132 @@
+#include "LatencyTracker.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+void LatencyTracker::AddFrameEvents(std::span<const TracedInput> events, uint64_t frameNumber)
+{
+    for (const auto& event : events) {
+        // Only full if nothing is presented for a long time, then the samples wouldn't be meaningful anyway
+        _pendingEvents.TryPush(PendingEvent { event, frameNumber });
+    }
+}
+
+void LatencyTracker::OnFramePresented(uint64_t frameNumber)
+{
+    // The timestamps of the events are 32 bit SDL_GetTicks values, the unsigned difference handles the wrap around
+    auto now = uint32_t(SDL_GetTicks64());
+
+    PendingEvent pending;
+    while (_nextEvent || _pendingEvents.TryPop(pending)) {
+        if (_nextEvent) {
+            pending = *_nextEvent;
+            _nextEvent.reset();
+        }
+
+        if (pending.FrameNumber > frameNumber) {
+            _nextEvent = pending;
+            break;
+        }
+
+        _histograms[size_t(pending.Event.Kind)].Add(double(now - pending.Event.TimestampMs));
+    }
+}
+
+void LatencyTracker::AddDrawnDragLag(std::span<const PositionSample> cursorPath, Vec2 drawnPosition, uint32_t dragStartMs, uint32_t updateMs, uint32_t presentMs)
+{
+    auto searchStartMs = updateMs - std::min(updateMs - dragStartMs, presentMs - updateMs);
+
+    // The cursor can't be matched to the positions it only reaches after the present
+    auto pathEnd = std::upper_bound(cursorPath.begin(), cursorPath.end(), presentMs, [](uint32_t timestampMs, const PositionSample& sample) {
+        return timestampMs < sample.TimestampMs;
+    });
+
+    // The latest of the closest positions. The last one before the search start is where the cursor was at the start
+    auto closest = pathEnd;
+    for (auto it = pathEnd; it != cursorPath.begin(); --it) {
+        if (closest == pathEnd || (it - 1)->Position.DistanceSquared(drawnPosition) < closest->Position.DistanceSquared(drawnPosition)) {
+            closest = it - 1;
+        }
+
+        if ((it - 1)->TimestampMs <= searchStartMs) {
+            break;
+        }
+    }
+
+    if (closest == pathEnd) {
+        return;
+    }
+
+    // The cursor stayed at the position until the next sample
+    auto leftMs = closest + 1 == pathEnd ? presentMs : (closest + 1)->TimestampMs;
+    _drawnDragLags.Add(double(presentMs - leftMs));
+}
+
+const FrameTimeHistogram& LatencyTracker::GetHistogram(InputEventKind kind) const
+{
+    return _histograms[size_t(kind)];
+}
+
+std::vector<std::string> LatencyTracker::GetSummaryLines() const
+{
+    std::vector<std::string> lines;
+
+    for (size_t i = 0; i < _histograms.size(); ++i) {
+        const auto& histogram = _histograms[i];
+        if (histogram.GetCount() == 0) {
+            continue;
+        }
+
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(0) << GetInputEventKindName(InputEventKind(i)) << ": " << histogram.GetPercentile(50)
+             << " / " << histogram.GetPercentile(95) << " / " << histogram.GetPercentile(99) << " ms";
+        lines.push_back(line.str());
+    }
+
+    return lines;
+}
+
+void LatencyTracker::PrintSummary(std::ostream& stream) const
+{
+    // The replays don't present their frames, they only have the drawn drag lags
+    if (std::any_of(_histograms.begin(), _histograms.end(), [](const FrameTimeHistogram& histogram) { return histogram.GetCount() != 0; })) {
+        stream << "Input latency until present (p50 / p95 / p99):" << std::endl;
+        for (size_t i = 0; i < _histograms.size(); ++i) {
+            const auto& histogram = _histograms[i];
+            if (histogram.GetCount() != 0) {
+                stream << "  " << GetInputEventKindName(InputEventKind(i)) << ": " << histogram.GetPercentile(50) << " / " << histogram.GetPercentile(95)
+                       << " / " << histogram.GetPercentile(99) << " ms, max: " << histogram.GetMax() << " ms, events: " << histogram.GetCount() << std::endl;
+            }
+        }
+    }
+
+    if (_drawnDragLags.GetCount() != 0) {
+        stream << "Dragged cell behind the cursor at present (p50 / p95 / p99): " << _drawnDragLags.GetPercentile(50) << " / " << _drawnDragLags.GetPercentile(95)
+               << " / " << _drawnDragLags.GetPercentile(99) << " ms, mean: " << _drawnDragLags.GetMean() << " ms, frames: " << _drawnDragLags.GetCount() << std::endl;
+    }
+}
+
+bool LatencyTracker::WriteHistograms(const std::string& filePath) const
+{
+    std::ofstream file { filePath };
+    if (!file) {
+        std::cerr << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < _histograms.size(); ++i) {
+        const auto& histogram = _histograms[i];
+        for (size_t bucket = 0; bucket < FrameTimeHistogram::BucketCount; ++bucket) {
+            if (auto count = histogram.GetBucketCount(bucket); count != 0) {
+                file << GetInputEventKindName(InputEventKind(i)) << ',' << (bucket + 1) * FrameTimeHistogram::BucketWidthMs << ',' << count << '\n';
+            }
+        }
+    }
+
+    return bool(file);
+}
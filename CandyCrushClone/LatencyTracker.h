@@ -0,0 +1,53 @@
+#pragma once
+
+#include "FramePacer.h"
+#include "InputProcessor.h"
+#include "SpscQueue.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+// Measures the input-to-photon latency: the time from the SDL event to the Present of the first frame showing its
+// effect. The frames are numbered when they are recorded, and the visible events of a frame are passed to the thread
+// presenting it, which completes every event up to the number of the presented frame. So the frames skipped by the
+// triple buffer don't lose their events. The SDL timestamps have a millisecond resolution.
+// The replays also measure how far behind the cursor the dragged cell is drawn, which the drag prediction reduces
+class LatencyTracker {
+public:
+    // Recording thread: the events that are first shown by the frame with the given number
+    void AddFrameEvents(std::span<const TracedInput> events, uint64_t frameNumber);
+    // Presenting thread: call right after Present
+    void OnFramePresented(uint64_t frameNumber);
+    // Replays: the dragged cell of a frame is drawn where the cursor was some time before the present. Adds the time
+    // since the cursor was last at the drawn position, 0 if it is still there. Only the positions from as long before
+    // the update as the present is after it are matched, the older ones of a curved drag could be closer to the
+    // extrapolated position by chance. The path has to be ordered by time
+    void AddDrawnDragLag(std::span<const PositionSample> cursorPath, Vec2 drawnPosition, uint32_t dragStartMs, uint32_t updateMs, uint32_t presentMs);
+
+    const FrameTimeHistogram& GetHistogram(InputEventKind kind) const;
+    // One line for every kind of event with samples: p50/p95/p99 in ms
+    std::vector<std::string> GetSummaryLines() const;
+    void PrintSummary(std::ostream& stream) const;
+    // Writes the non-empty buckets as "kind,upper edge in ms,count" lines
+    bool WriteHistograms(const std::string& filePath) const;
+
+private:
+    struct PendingEvent {
+        TracedInput Event;
+        uint64_t FrameNumber;
+    };
+
+    static constexpr size_t PendingEventCapacity = 1024;
+
+    SpscQueue<PendingEvent, PendingEventCapacity> _pendingEvents;
+    // Popped already, but it belongs to a frame that wasn't presented yet
+    std::optional<PendingEvent> _nextEvent;
+    std::array<FrameTimeHistogram, InputEventKindCount> _histograms;
+    FrameTimeHistogram _drawnDragLags;
+};
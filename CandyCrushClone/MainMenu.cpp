@@ -4,11 +4,6 @@
 #include "MainMenu.h"
 
 namespace {
-bool Contains(const SDL_Rect& rect, Vec2 position)
-{
-    return position.x >= rect.x && position.y >= rect.y && position.x <= rect.x + rect.w && position.y <= rect.y + rect.h;
-}
-
 int GetCenteredPositionOfElement(int screenWidth, int elementWidth)
 {
     return (screenWidth - elementWidth) / 2;
@@ -47,42 +42,47 @@ MainMenu::MainMenu(const Screen& screen, InputProcessor& inputProcessor)
         ButtonType::Quit,
     }
 {
-    MakeMenuFromButtonTypes();
-    _leaderboardButtons = std::vector<Button> {
-        GetMusicButton(),
-        Button { ButtonType::Back, GetTextForButtonType(ButtonType::Back), SDL_Rect { GetCenteredPositionOfElement(screen.ScreenWidth, ButtonWidth), screen.ScreenHeight - 80, ButtonWidth, ButtonHeight } },
-    };
+    _mainPage.UseLargeFont = true;
 }
 
-void MainMenu::Draw()
+void MainMenu::Draw(DrawList& drawList)
 {
-    for (const auto& button : CurrentButtons()) {
-        _screen->DrawButton(button.Text, button.Position, button.Type == _hoveredButton);
+    _needsRedraw = false;
+
+    const auto& page = GetCurrentPage();
+    for (const auto& button : page.Buttons) {
+        drawList.DrawButton(button.Text, button.Position, button.Type == _hoveredButton);
     }
 
-    if (_isShowingLeaderboard) {
-        _screen->DrawBackgroundRectangle(_leaderboardBackground);
-        for (const auto& textBlock : _leaderboard) {
-            _screen->DrawText(textBlock.Text, textBlock.Position, false);
-        }
-    } else {
-        for (const auto& textBlock : _additionalText) {
-            _screen->DrawText(textBlock.Text, textBlock.Position, true);
-        }
+    if (page.Background) {
+        drawList.DrawBackgroundRectangle(*page.Background);
     }
+
+    for (const auto& textBlock : page.Texts) {
+        drawList.DrawText(textBlock.Text, textBlock.Position, page.UseLargeFont);
+    }
+}
+
+bool MainMenu::NeedsRedraw() const
+{
+    return _needsRedraw;
 }
 
 void MainMenu::Activate(bool needsResumeButton, const std::vector<std::string>& additionalText)
 {
-    _additionalText.clear();
-    MakeTextBlocksFromTexts(additionalText, _additionalText, 100, ButtonSpacing, ButtonHeight);
+    _needsRedraw = true;
+
+    if (additionalText != _additionalText) {
+        _additionalText = additionalText;
+        InvalidateLayout(_mainPage);
+    }
 
     if (needsResumeButton && _buttonTypes[0] != ButtonType::Resume) {
         _buttonTypes.insert(_buttonTypes.begin(), ButtonType::Resume);
-        MakeMenuFromButtonTypes();
+        InvalidateLayout(_mainPage);
     } else if (!needsResumeButton && _buttonTypes[0] == ButtonType::Resume) {
         _buttonTypes.erase(_buttonTypes.begin());
-        MakeMenuFromButtonTypes();
+        InvalidateLayout(_mainPage);
     }
 
     _mouseClickedEventToken = _inputProcessor->MouseClicked.Subscribe([this](Vec2 position) { TryClick(position); });
@@ -91,43 +91,70 @@ void MainMenu::Activate(bool needsResumeButton, const std::vector<std::string>&
 
 void MainMenu::Deactivate()
 {
-    _mouseClickedEventToken.reset();
-    _mouseMovedEventToken.reset();
+    _mouseClickedEventToken.Reset();
+    _mouseMovedEventToken.Reset();
 
     _hoveredButton.reset();
 }
 
 void MainMenu::ShowLeaderboard(const std::vector<int>& classicHighScores, const std::vector<int>& quickDeathHighScores)
 {
-    _leaderboard.clear();
-    _leaderboard.reserve(12);
-
-    _leaderboard.push_back(TextBlock { "Classic:", SDL_Rect {
-                                                       GetCenteredPositionOfElement(_screen->ScreenWidth, ButtonWidth),
-                                                       50,
-                                                       ButtonWidth,
-                                                       LeaderboardEntryHeight,
-                                                   } });
-
-    int nextYPosition = MakeTextBlocksFromMilliseconds(classicHighScores, _leaderboard, 50 + LeaderboardSpacing + LeaderboardEntryHeight, LeaderboardSpacing);
-
-    _leaderboard.push_back(TextBlock { "Quick death:", SDL_Rect { GetCenteredPositionOfElement(_screen->ScreenWidth, ButtonWidth), nextYPosition, ButtonWidth, LeaderboardEntryHeight } });
-
-    MakeTextBlocksFromMilliseconds(quickDeathHighScores, _leaderboard, nextYPosition + LeaderboardEntryHeight + LeaderboardSpacing, LeaderboardSpacing);
-
-    _leaderboardBackground = SDL_Rect { _leaderboard[0].Position.x - LeaderboardSpacing, _leaderboard[0].Position.y - LeaderboardSpacing, ButtonWidth + 2 * LeaderboardSpacing, int(_leaderboard.size()) * (LeaderboardSpacing + LeaderboardEntryHeight) + LeaderboardSpacing };
+    if (classicHighScores != _classicHighScores || quickDeathHighScores != _quickDeathHighScores) {
+        _classicHighScores = classicHighScores;
+        _quickDeathHighScores = quickDeathHighScores;
+        InvalidateLayout(_leaderboardPage);
+    }
 
     _isShowingLeaderboard = true;
+    _needsRedraw = true;
 }
 
 void MainMenu::GoBackFromLeaderboard()
 {
     _isShowingLeaderboard = false;
+    _needsRedraw = true;
 }
 
-std::vector<MainMenu::Button>& MainMenu::CurrentButtons()
+std::optional<SDL_Rect> MainMenu::GetButtonPosition(ButtonType type)
 {
-    return _isShowingLeaderboard ? _leaderboardButtons : _buttons;
+    for (const auto& button : GetCurrentPage().Buttons) {
+        if (button.Type == type) {
+            return button.Position;
+        }
+    }
+
+    return std::nullopt;
+}
+
+MainMenu::Page& MainMenu::GetCurrentPage()
+{
+    auto& page = _isShowingLeaderboard ? _leaderboardPage : _mainPage;
+    if (!page.IsLayoutValid) {
+        page.Buttons.clear();
+        page.Texts.clear();
+        page.Background.reset();
+
+        if (&page == &_mainPage) {
+            LayOutMainPage(page);
+        } else {
+            LayOutLeaderboardPage(page);
+        }
+
+        page.ButtonIndex.Clear();
+        for (int i = 0; i < int(page.Buttons.size()); ++i) {
+            page.ButtonIndex.Insert(page.Buttons[i].Position, i);
+        }
+
+        page.IsLayoutValid = true;
+    }
+
+    return page;
+}
+
+void MainMenu::InvalidateLayout(Page& page)
+{
+    page.IsLayoutValid = false;
+    _needsRedraw = true;
 }
 
 MainMenu::Button MainMenu::GetMusicButton() const
@@ -139,16 +166,7 @@ MainMenu::Button MainMenu::GetMusicButton() const
     };
 }
 
-void MainMenu::UpdateMusicButton()
-{
-    auto& currentButtons = CurrentButtons();
-    auto musicButtonIt = std::find_if(currentButtons.begin(), currentButtons.end(), [](const Button& button) { return button.Type == ButtonType::ToggleMusic; });
-    if (musicButtonIt != currentButtons.end()) {
-        *musicButtonIt = GetMusicButton();
-    }
-}
-
-void MainMenu::MakeMenuFromButtonTypes()
+void MainMenu::LayOutMainPage(Page& page) const
 {
     auto screenWidth = _screen->ScreenWidth;
     auto screenHeight = _screen->ScreenHeight;
@@ -159,13 +177,11 @@ void MainMenu::MakeMenuFromButtonTypes()
     auto buttonYPosition = (screenHeight - menuSize) / 2;
     auto buttonXPosition = GetCenteredPositionOfElement(screenWidth, ButtonWidth);
 
-    _buttons.reserve(numOfButtons);
-    _buttons.clear();
-
-    _buttons.push_back(GetMusicButton());
+    page.Buttons.reserve(numOfButtons + 1);
+    page.Buttons.push_back(GetMusicButton());
 
     for (auto buttonType : _buttonTypes) {
-        _buttons.push_back(Button {
+        page.Buttons.push_back(Button {
             buttonType,
             GetTextForButtonType(buttonType),
             SDL_Rect { buttonXPosition, buttonYPosition, ButtonWidth, ButtonHeight },
@@ -173,9 +189,35 @@ void MainMenu::MakeMenuFromButtonTypes()
 
         buttonYPosition += (ButtonHeight + ButtonSpacing);
     }
+
+    MakeTextBlocksFromTexts(_additionalText, page.Texts, 100, ButtonSpacing, ButtonHeight);
 }
 
-int MainMenu::MakeTextBlocksFromTexts(const std::vector<std::string>& additionalText, std::vector<TextBlock>& resultTexts, int startingYPosition, int spacing, int height)
+void MainMenu::LayOutLeaderboardPage(Page& page) const
+{
+    page.Buttons.push_back(GetMusicButton());
+    page.Buttons.push_back(Button { ButtonType::Back, GetTextForButtonType(ButtonType::Back), SDL_Rect { GetCenteredPositionOfElement(_screen->ScreenWidth, ButtonWidth), _screen->ScreenHeight - 80, ButtonWidth, ButtonHeight } });
+
+    auto& texts = page.Texts;
+    texts.reserve(_classicHighScores.size() + _quickDeathHighScores.size() + 2);
+
+    texts.push_back(TextBlock { "Classic:", SDL_Rect {
+                                                GetCenteredPositionOfElement(_screen->ScreenWidth, ButtonWidth),
+                                                50,
+                                                ButtonWidth,
+                                                LeaderboardEntryHeight,
+                                            } });
+
+    int nextYPosition = MakeTextBlocksFromMilliseconds(_classicHighScores, texts, 50 + LeaderboardSpacing + LeaderboardEntryHeight, LeaderboardSpacing);
+
+    texts.push_back(TextBlock { "Quick death:", SDL_Rect { GetCenteredPositionOfElement(_screen->ScreenWidth, ButtonWidth), nextYPosition, ButtonWidth, LeaderboardEntryHeight } });
+
+    MakeTextBlocksFromMilliseconds(_quickDeathHighScores, texts, nextYPosition + LeaderboardEntryHeight + LeaderboardSpacing, LeaderboardSpacing);
+
+    page.Background = SDL_Rect { texts[0].Position.x - LeaderboardSpacing, texts[0].Position.y - LeaderboardSpacing, ButtonWidth + 2 * LeaderboardSpacing, int(texts.size()) * (LeaderboardSpacing + LeaderboardEntryHeight) + LeaderboardSpacing };
+}
+
+int MainMenu::MakeTextBlocksFromTexts(const std::vector<std::string>& additionalText, std::vector<TextBlock>& resultTexts, int startingYPosition, int spacing, int height) const
 {
     auto midPoint = GetCenteredPositionOfElement(_screen->ScreenWidth, TextBlockWidth);
     SDL_Rect textRect { midPoint, startingYPosition, TextBlockWidth, height };
@@ -187,7 +229,7 @@ int MainMenu::MakeTextBlocksFromTexts(const std::vector<std::string>& additional
     return textRect.y;
 }
 
-int MainMenu::MakeTextBlocksFromMilliseconds(const std::vector<int>& data, std::vector<TextBlock>& resultTexts, int startingYPosition, int spacing)
+int MainMenu::MakeTextBlocksFromMilliseconds(const std::vector<int>& data, std::vector<TextBlock>& resultTexts, int startingYPosition, int spacing) const
 {
     std::vector<std::string> stringVec;
     stringVec.reserve(data.size());
@@ -198,28 +240,40 @@ int MainMenu::MakeTextBlocksFromMilliseconds(const std::vector<int>& data, std::
 
 void MainMenu::TryClick(Vec2 position)
 {
-    for (const auto& button : CurrentButtons()) {
-        if (Contains(button.Position, position)) {
-            // Handle some buttons' action here before forwarding it to the subscribers
-            if (button.Type == ButtonType::Back) {
-                GoBackFromLeaderboard();
-            } else if (button.Type == ButtonType::ToggleMusic) {
-                _isPlayingMusic = !_isPlayingMusic;
-                UpdateMusicButton();
-            }
-
-            ButtonClicked.Invoke(button.Type);
-        }
+    auto& page = GetCurrentPage();
+    auto buttonIndex = page.ButtonIndex.Find(position);
+    if (!buttonIndex) {
+        return;
+    }
+
+    auto buttonType = page.Buttons[*buttonIndex].Type;
+
+    // Handle some buttons' action here before forwarding it to the subscribers
+    if (buttonType == ButtonType::Back) {
+        GoBackFromLeaderboard();
+    } else if (buttonType == ButtonType::ToggleMusic) {
+        _isPlayingMusic = !_isPlayingMusic;
+        // Both pages show the music button
+        InvalidateLayout(_mainPage);
+        InvalidateLayout(_leaderboardPage);
     }
+
+    _inputProcessor->MarkCurrentEventVisible();
+    ButtonClicked.Invoke(buttonType);
 }
 
 void MainMenu::TryHover(Vec2 position)
 {
-    _hoveredButton.reset();
+    std::optional<ButtonType> hoveredButton;
 
-    for (const auto& button : CurrentButtons()) {
-        if (Contains(button.Position, position)) {
-            _hoveredButton = button.Type;
-        }
+    auto& page = GetCurrentPage();
+    if (auto buttonIndex = page.ButtonIndex.Find(position)) {
+        hoveredButton = page.Buttons[*buttonIndex].Type;
+    }
+
+    if (hoveredButton != _hoveredButton) {
+        _hoveredButton = hoveredButton;
+        _needsRedraw = true;
+        _inputProcessor->MarkCurrentEventVisible();
     }
 }
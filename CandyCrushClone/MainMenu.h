@@ -1,9 +1,12 @@
 #pragma once
 
+#include "DrawList.h"
 #include "Event.h"
+#include "HitTestGrid.h"
 #include "InputProcessor.h"
 #include "Screen.h"
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -17,16 +20,22 @@ enum class ButtonType {
     ToggleMusic,
 };
 
+// The pages of the menu are retained between the frames with their laid out elements. A page is laid out again only
+// when its content changes, and the buttons are found through a grid index, so the cost of hovering and clicking
+// doesn't grow with the number of buttons
 class MainMenu {
 public:
     MainMenu(const Screen& screen, InputProcessor& inputProcessor);
 
-    void Draw();
+    void Draw(DrawList& drawList);
+    bool NeedsRedraw() const;
     void Activate(bool needsResumeButton, const std::vector<std::string>& additionalText);
     void Deactivate();
     void ShowLeaderboard(const std::vector<int>& classicHighScores, const std::vector<int>& quickDeathHighScores);
+    // nullopt if the button is not shown at the moment
+    std::optional<SDL_Rect> GetButtonPosition(ButtonType type);
 
-    Event<std::function<void(ButtonType clickedButton)>> ButtonClicked;
+    Event<void(ButtonType clickedButton)> ButtonClicked;
 
 private:
     static constexpr int ButtonHeight = 40;
@@ -35,6 +44,7 @@ private:
     static constexpr int ButtonSpacing = 20;
     static constexpr int LeaderboardEntryHeight = 25;
     static constexpr int LeaderboardSpacing = 5;
+    static constexpr int HitTestCellSize = 64;
 
     struct Button {
         ButtonType Type;
@@ -47,33 +57,47 @@ private:
         SDL_Rect Position;
     };
 
+    // The laid out elements of a page, valid until the content of the page changes
+    struct Page {
+        std::vector<Button> Buttons;
+        std::vector<TextBlock> Texts;
+        std::optional<SDL_Rect> Background;
+        bool UseLargeFont = false;
+        // Maps the positions to the indices of the buttons
+        HitTestGrid ButtonIndex { Screen::ScreenWidth, Screen::ScreenHeight, HitTestCellSize };
+        bool IsLayoutValid = false;
+    };
+
     const Screen* _screen;
     InputProcessor* _inputProcessor;
-    std::unique_ptr<EventToken> _userClickedEventToken;
-    std::vector<Button> _buttons;
-    std::vector<Button> _leaderboardButtons;
-
-    std::vector<TextBlock> _additionalText;
-    std::vector<TextBlock> _leaderboard;
-    SDL_Rect _leaderboardBackground;
+    EventToken _userClickedEventToken;
 
+    // The content of the pages, the layout is computed from these
     std::vector<ButtonType> _buttonTypes;
+    std::vector<std::string> _additionalText;
+    std::vector<int> _classicHighScores;
+    std::vector<int> _quickDeathHighScores;
 
-    std::unique_ptr<EventToken> _mouseClickedEventToken;
-    std::unique_ptr<EventToken> _mouseMovedEventToken;
+    Page _mainPage;
+    Page _leaderboardPage;
+
+    EventToken _mouseClickedEventToken;
+    EventToken _mouseMovedEventToken;
     std::optional<ButtonType> _hoveredButton;
 
     bool _isShowingLeaderboard = false;
     bool _isPlayingMusic = true;
-
-    void MakeMenuFromButtonTypes();
-    int MakeTextBlocksFromTexts(const std::vector<std::string>& additionalText, std::vector<TextBlock>& resultTexts, int startingYPosition, int spacing, int height);
-    int MakeTextBlocksFromMilliseconds(const std::vector<int>& data, std::vector<TextBlock>& resultTexts, int startingYPosition, int spacing);
+    bool _needsRedraw = true;
+
+    // Lays out the shown page first if its content changed since its last layout
+    Page& GetCurrentPage();
+    void InvalidateLayout(Page& page);
+    void LayOutMainPage(Page& page) const;
+    void LayOutLeaderboardPage(Page& page) const;
+    int MakeTextBlocksFromTexts(const std::vector<std::string>& additionalText, std::vector<TextBlock>& resultTexts, int startingYPosition, int spacing, int height) const;
+    int MakeTextBlocksFromMilliseconds(const std::vector<int>& data, std::vector<TextBlock>& resultTexts, int startingYPosition, int spacing) const;
     void TryClick(Vec2 position);
     void TryHover(Vec2 position);
     void GoBackFromLeaderboard();
-    std::vector<Button>& CurrentButtons();
     Button GetMusicButton() const;
-
-    void UpdateMusicButton();
 };
@@ -0,0 +1,444 @@
+#include "Microbenchmarks.h"
+
+#include "Easing.h"
+#include "Event.h"
+#include "FallSimulator.h"
+#include "MpscQueue.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+static constexpr size_t EasingTrackCount = 4096;
+static constexpr int EasingIterationCount = 2000;
+static constexpr const char* const EasingFunctionNames[] = { "Linear", "EaseInQuad", "EaseOutQuad", "EaseInCubic", "EaseOutCubic",
+    "EaseInOutCubic", "EaseInOutSine", "EaseOutBack", "EaseOutBounce" };
+
+static_assert(std::size(EasingFunctionNames) == size_t(EasingFunction::Count));
+
+static constexpr int EventSubscriberCount = 4;
+static constexpr int EventIterationCount = 1000000;
+
+// The event as it used to be: std::function subscribers, heap allocated tokens and null slots left behind
+class LegacyEventToken {
+public:
+    explicit LegacyEventToken(std::function<void()> unsubAction)
+        : _unsubAction(std::move(unsubAction))
+    {
+    }
+    ~LegacyEventToken() { _unsubAction(); }
+
+private:
+    std::function<void()> _unsubAction;
+};
+
+template <class T>
+class LegacyEvent {
+public:
+    [[nodiscard]] std::unique_ptr<LegacyEventToken> Subscribe(T&& action)
+    {
+        auto initialSize = _subscribers.size();
+
+        for (size_t i = 0; i < initialSize; ++i) {
+            if (!_subscribers[i]) {
+                _subscribers[i] = std::move(action);
+
+                return std::make_unique<LegacyEventToken>([this, i]() { _subscribers[i] = nullptr; });
+            }
+        }
+
+        _subscribers.push_back(std::move(action));
+        return std::make_unique<LegacyEventToken>([this, initialSize]() { _subscribers[initialSize] = nullptr; });
+    }
+
+    template <class... Params>
+    void Invoke(Params&&... params)
+    {
+        for (const auto& subscriber : _subscribers) {
+            if (subscriber)
+                subscriber(std::forward<Params>(params)...);
+        }
+    }
+
+private:
+    std::vector<T> _subscribers;
+};
+
+double GetSecondsSince(uint64_t startCounter)
+{
+    return double(SDL_GetPerformanceCounter() - startCounter) / SDL_GetPerformanceFrequency();
+}
+
+// The easing functions as they used to be evaluated, with libm calls and branches
+double EvaluateWithLibm(EasingFunction function, double x)
+{
+    switch (function) {
+    case EasingFunction::EaseInQuad:
+        return pow(x, 2);
+    case EasingFunction::EaseOutQuad:
+        return 1 - pow(1 - x, 2);
+    case EasingFunction::EaseInCubic:
+        return pow(x, 3);
+    case EasingFunction::EaseOutCubic:
+        return 1 - pow(1 - x, 3);
+    case EasingFunction::EaseInOutCubic:
+        return x < 0.5 ? 4 * pow(x, 3) : 1 - pow(-2 * x + 2, 3) / 2;
+    case EasingFunction::EaseInOutSine:
+        return -(cos(M_PI * x) - 1) / 2;
+    case EasingFunction::EaseOutBack:
+        return 1 + 2.70158 * pow(x - 1, 3) + 1.70158 * pow(x - 1, 2);
+    case EasingFunction::EaseOutBounce: {
+        static const double n1 = 7.5625;
+        static const double d1 = 2.75;
+
+        if (x < 1 / d1) {
+            return n1 * x * x;
+        } else if (x < 2 / d1) {
+            x -= 1.5 / d1;
+            return n1 * x * x + 0.75;
+        } else if (x < 2.5 / d1) {
+            x -= 2.25 / d1;
+            return n1 * x * x + 0.9375;
+        } else {
+            x -= 2.625 / d1;
+            return n1 * x * x + 0.984375;
+        }
+    }
+    default:
+        return x;
+    }
+}
+
+// Runs evaluate(iteration) EasingIterationCount times, prints and returns the time of one evaluation in nanoseconds
+double MeasureEasing(const std::string& name, const std::function<double(int iteration)>& evaluate, std::optional<double> baselineNs = std::nullopt)
+{
+    double checksum = 0.0;
+
+    auto start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < EasingIterationCount; ++i) {
+        checksum += evaluate(i);
+    }
+    auto nsPerEvaluation = GetSecondsSince(start) * 1e9 / (double(EasingIterationCount) * EasingTrackCount);
+
+    std::cout << "  " << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(2)
+              << nsPerEvaluation << " ns per evaluation";
+    if (baselineNs) {
+        std::cout << " (" << std::setprecision(1) << *baselineNs / nsPerEvaluation << "x)";
+    }
+    std::cout << ", checksum " << std::setprecision(3) << checksum << std::endl;
+
+    return nsPerEvaluation;
+}
+
+void BenchmarkEasingMix(const std::string& name, const std::vector<EasingFunction>& functionsToUse)
+{
+    std::vector<EasingFunction> functions(EasingTrackCount);
+    std::vector<float> progress(EasingTrackCount);
+    std::vector<float> results(EasingTrackCount);
+
+    for (size_t i = 0; i < EasingTrackCount; ++i) {
+        functions[i] = functionsToUse[i % functionsToUse.size()];
+        progress[i] = float((i * 7919) % EasingTrackCount) / EasingTrackCount;
+    }
+
+    // Every iteration moves the tracks a bit forward, like a frame does
+    auto advance = [&progress](int iteration, size_t i) {
+        auto value = progress[i] + float(iteration) / EasingIterationCount;
+        return value > 1.0f ? value - 1.0f : value;
+    };
+
+    std::cout << name << ":" << std::endl;
+
+    auto libmNs = MeasureEasing(
+        "libm", [&](int iteration) {
+            double sum = 0.0;
+            for (size_t i = 0; i < EasingTrackCount; ++i) {
+                sum += EvaluateWithLibm(functions[i], advance(iteration, i));
+            }
+            return sum;
+        });
+
+    MeasureEasing(
+        "table", [&](int iteration) {
+            double sum = 0.0;
+            for (size_t i = 0; i < EasingTrackCount; ++i) {
+                sum += Easing::Evaluate(functions[i], advance(iteration, i));
+            }
+            return sum;
+        },
+        libmNs);
+
+    MeasureEasing(
+        "table batch", [&](int iteration) {
+            for (size_t i = 0; i < EasingTrackCount; ++i) {
+                results[i] = advance(iteration, i);
+            }
+
+            Easing::Evaluate(functions.data(), results.data(), results.data(), EasingTrackCount);
+
+            double sum = 0.0;
+            for (auto result : results) {
+                sum += result;
+            }
+            return sum;
+        },
+        libmNs);
+}
+
+int RunEasingBenchmark()
+{
+    std::cout << "Maximum error of the tables:" << std::endl;
+    for (size_t function = 0; function < size_t(EasingFunction::Count); ++function) {
+        double maxError = 0.0;
+        for (int i = 0; i <= 100000; ++i) {
+            auto x = i / 100000.0;
+            maxError = std::max(maxError, std::abs(Easing::Evaluate(EasingFunction(function), float(x)) - Easing::EvaluateExact(EasingFunction(function), x)));
+        }
+
+        std::cout << "  " << std::left << std::setw(15) << EasingFunctionNames[function] << std::right << std::scientific << std::setprecision(2) << maxError << std::defaultfloat << std::endl;
+    }
+
+    std::vector<EasingFunction> allFunctions;
+    for (size_t function = 0; function < size_t(EasingFunction::Count); ++function) {
+        allFunctions.push_back(EasingFunction(function));
+    }
+
+    BenchmarkEasingMix("The functions used by the game (EaseInCubic, EaseOutBounce)", { EasingFunction::EaseInCubic, EasingFunction::EaseOutBounce });
+    BenchmarkEasingMix("Every function", allFunctions);
+
+    std::cout << "sin of the active cell pulse:" << std::endl;
+    auto libmNs = MeasureEasing(
+        "libm", [](int iteration) {
+            double sum = 0.0;
+            for (size_t i = 0; i < EasingTrackCount; ++i) {
+                sum += sin((iteration * EasingTrackCount + i) / 1000.f * 2 * M_PI);
+            }
+            return sum;
+        });
+    MeasureEasing(
+        "table", [](int iteration) {
+            double sum = 0.0;
+            for (size_t i = 0; i < EasingTrackCount; ++i) {
+                sum += Easing::SinTurns((iteration * EasingTrackCount + i) / 1000.f);
+            }
+            return sum;
+        },
+        libmNs);
+
+    return 0;
+}
+
+// Invokes an event with a few subscribers, then subscribes and unsubscribes one repeatedly next to them.
+// Returns the nanoseconds of an invoke and of a subscribe + unsubscribe pair
+template <class EventType, class TokenType>
+std::pair<double, double> MeasureEvent(const std::string& name)
+{
+    EventType event;
+    int64_t sum = 0;
+
+    std::vector<TokenType> tokens;
+    for (int i = 0; i < EventSubscriberCount; ++i) {
+        tokens.push_back(event.Subscribe([&sum, i](int value) { sum += value * (i + 1); }));
+    }
+
+    auto start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < EventIterationCount; ++i) {
+        event.Invoke(i);
+    }
+    auto invokeNs = GetSecondsSince(start) * 1e9 / EventIterationCount;
+
+    start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < EventIterationCount; ++i) {
+        auto token = event.Subscribe([&sum](int value) { sum -= value; });
+    }
+    auto subscribeNs = GetSecondsSince(start) * 1e9 / EventIterationCount;
+
+    std::cout << std::setw(8) << name << ": invoke with " << EventSubscriberCount << " subscribers " << std::fixed << std::setprecision(2)
+              << invokeNs << " ns, subscribe + unsubscribe " << subscribeNs << " ns (checksum " << sum << ")" << std::endl;
+
+    return { invokeNs, subscribeNs };
+}
+
+int RunEventBenchmark()
+{
+    auto [legacyInvokeNs, legacySubscribeNs] = MeasureEvent<LegacyEvent<std::function<void(int)>>, std::unique_ptr<LegacyEventToken>>("Legacy");
+    auto [invokeNs, subscribeNs] = MeasureEvent<Event<void(int)>, EventToken>("Event");
+
+    std::cout << "Speedup: invoke " << std::setprecision(2) << legacyInvokeNs / invokeNs << "x, subscribe + unsubscribe "
+              << legacySubscribeNs / subscribeNs << "x" << std::endl;
+
+    return 0;
+}
+
+struct QueueTestMessage {
+    uint32_t Producer = 0;
+    uint32_t Sequence = 0;
+};
+
+// The baseline for the lock-free queue, unbounded, so its producers never have to wait
+class MutexQueue {
+public:
+    bool TryPush(QueueTestMessage message)
+    {
+        std::lock_guard lock { _mutex };
+        _messages.push(message);
+        return true;
+    }
+
+    bool TryPop(QueueTestMessage& message)
+    {
+        std::lock_guard lock { _mutex };
+        if (_messages.empty()) {
+            return false;
+        }
+
+        message = _messages.front();
+        _messages.pop();
+        return true;
+    }
+
+private:
+    std::mutex _mutex;
+    std::queue<QueueTestMessage> _messages;
+};
+
+// Every producer pushes its messages with increasing sequence numbers as fast as it can, the calling thread pops them.
+// Returns the number of errors: lost, duplicated or reordered messages of a producer
+template <class Queue>
+int MeasureQueue(const std::string& name, int producerCount)
+{
+    static constexpr uint32_t MessageCount = 2000000;
+
+    Queue queue;
+    auto messagesPerProducer = MessageCount / producerCount;
+
+    auto start = SDL_GetPerformanceCounter();
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < producerCount; ++i) {
+        producers.emplace_back([&queue, messagesPerProducer, i] {
+            for (uint32_t sequence = 0; sequence < messagesPerProducer; ++sequence) {
+                while (!queue.TryPush(QueueTestMessage { uint32_t(i), sequence })) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    int errorCount = 0;
+    std::vector<uint32_t> nextSequences(producerCount, 0);
+    QueueTestMessage message;
+    for (uint32_t received = 0; received < messagesPerProducer * producerCount;) {
+        if (queue.TryPop(message)) {
+            if (message.Producer >= uint32_t(producerCount) || message.Sequence != nextSequences[message.Producer]) {
+                ++errorCount;
+            }
+
+            nextSequences[message.Producer % producerCount] = message.Sequence + 1;
+            ++received;
+        } else {
+            // Let the producers run, when there are fewer cores than threads
+            std::this_thread::yield();
+        }
+    }
+
+    auto seconds = GetSecondsSince(start);
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    std::cout << std::setw(6) << name << ", " << producerCount << " producers: " << std::fixed << std::setprecision(1)
+              << messagesPerProducer * producerCount / seconds / 1e6 << " million messages / s, " << errorCount << " errors" << std::endl;
+
+    return errorCount;
+}
+
+int RunMpscQueueBenchmark()
+{
+    int errorCount = 0;
+
+    for (int producerCount : { 1, 2, 4, 8 }) {
+        errorCount += MeasureQueue<MpscQueue<QueueTestMessage, 1024>>("MPSC", producerCount);
+        errorCount += MeasureQueue<MutexQueue>("Mutex", producerCount);
+    }
+
+    return errorCount == 0 ? 0 : 1;
+}
+
+int RunFallBenchmark()
+{
+    static constexpr int TileSize = 70;
+    static constexpr uint64_t FrameTimeMs = 16;
+
+    for (auto [columnCount, rowCount] : { std::pair { 8, 8 }, std::pair { 64, 64 }, std::pair { 256, 64 } }) {
+        FallSimulator fallSimulator { TileSize };
+
+        // Every column is refilled from above, the tiles fall 1 to 2 times the height of the board
+        for (int i = 0; i < columnCount; ++i) {
+            auto fallHeight = rowCount + (i * 7) % rowCount;
+            for (int j = 0; j < rowCount; ++j) {
+                fallSimulator.Add(i, j - fallHeight, j, 0);
+            }
+        }
+
+        int frameCount = 0;
+        double totalSeconds = 0.0;
+        double maxSeconds = 0.0;
+
+        while (fallSimulator.GetFallingTileCount() > 0) {
+            auto start = SDL_GetPerformanceCounter();
+            fallSimulator.Update(FrameTimeMs);
+            auto seconds = GetSecondsSince(start);
+
+            totalSeconds += seconds;
+            maxSeconds = std::max(maxSeconds, seconds);
+            ++frameCount;
+        }
+
+        std::cout << columnCount << "x" << rowCount << " board (" << columnCount * rowCount << " falling tiles): "
+                  << frameCount << " frames until every tile landed, " << std::fixed << std::setprecision(1)
+                  << totalSeconds * 1e6 / frameCount << " us per update on average, " << maxSeconds * 1e6 << " us at most ("
+                  << std::setprecision(2) << maxSeconds * 1e5 / FrameTimeMs << "% of the frame)" << std::endl;
+    }
+
+    return 0;
+}
+}
+
+int RunMicrobenchmark(const std::string& name)
+{
+    static const std::vector<std::pair<std::string, std::function<int()>>> benchmarks {
+        { "easing", RunEasingBenchmark },
+        { "fall", RunFallBenchmark },
+        { "event", RunEventBenchmark },
+        { "mpsc", RunMpscQueueBenchmark },
+    };
+
+    for (const auto& [benchmarkName, run] : benchmarks) {
+        if (benchmarkName == name) {
+            return run();
+        }
+    }
+
+    std::cerr << "Unknown benchmark " << name << ", the available ones are:";
+    for (const auto& [benchmarkName, run] : benchmarks) {
+        std::cerr << " " << benchmarkName;
+    }
+    std::cerr << std::endl;
+
+    return 1;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+
+// Benchmarks of code paths that don't need a screen, eg. the easing functions.
+// Prints the results and returns the exit code of the process. Unknown names print the available benchmarks
+int RunMicrobenchmark(const std::string& name);
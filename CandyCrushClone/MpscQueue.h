@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// A bounded queue that any number of threads can push to and one thread pops from, without locks (Dmitry Vyukov's
+// bounded queue). Every cell has a sequence number, which tells the producers and the consumer whose turn it is to use
+// the cell, so a producer only has to win a compare exchange on the tail, and the consumer never writes shared counters
+template <class T, size_t Capacity>
+class MpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "The capacity has to be a power of 2");
+
+public:
+    MpscQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i) {
+            _cells[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread: returns false if the queue is full
+    bool TryPush(T value)
+    {
+        auto position = _tail.load(std::memory_order_relaxed);
+
+        while (true) {
+            auto& cell = _cells[position & (Capacity - 1)];
+            auto difference = intptr_t(cell.Sequence.load(std::memory_order_acquire)) - intptr_t(position);
+
+            if (difference == 0) {
+                // The cell is free, claim it by moving the tail past it
+                if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.Value = std::move(value);
+                    cell.Sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                // The consumer hasn't popped this cell yet, the queue is full
+                return false;
+            } else {
+                // Another producer claimed the cell, try the next one
+                position = _tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Only the consumer thread: returns false if the queue is empty, or the next value is still being written
+    bool TryPop(T& value)
+    {
+        auto& cell = _cells[_head & (Capacity - 1)];
+        if (intptr_t(cell.Sequence.load(std::memory_order_acquire)) - intptr_t(_head + 1) < 0) {
+            return false;
+        }
+
+        value = std::move(cell.Value);
+        // The cell can be claimed again in the next round
+        cell.Sequence.store(_head + Capacity, std::memory_order_release);
+        ++_head;
+
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> Sequence;
+        T Value {};
+    };
+
+    std::array<Cell, Capacity> _cells;
+    alignas(64) std::atomic<size_t> _tail = 0;
+    // Only used by the consumer
+    alignas(64) size_t _head = 0;
+};
@@ -0,0 +1,108 @@
+#include "ParticleSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+static constexpr float MinSpeed = 0.05f; // Pixels / ms
+static constexpr float MaxSpeed = 0.35f;
+static constexpr float MinLifetimeMs = 400.0f;
+static constexpr float MaxLifetimeMs = 900.0f;
+static constexpr float MinSize = 3.0f;
+static constexpr float MaxSize = 8.0f;
+static constexpr float Pi = 3.14159265f;
+}
+
+ParticleSystem::ParticleSystem(unsigned int randomSeed)
+    : _positionsX(Capacity)
+    , _positionsY(Capacity)
+    , _velocitiesX(Capacity)
+    , _velocitiesY(Capacity)
+    , _lifeLeft(Capacity)
+    , _inverseLifetimes(Capacity)
+    , _sizes(Capacity)
+    , _colors(Capacity)
+    , _randomEngine(randomSeed)
+{
+}
+
+void ParticleSystem::SpawnBurst(Vec2 center, SDL_Color color, int count)
+{
+    std::uniform_real_distribution<float> unitDistribution(0.0f, 1.0f);
+    auto random = [this, &unitDistribution](float min, float max) {
+        return min + (max - min) * unitDistribution(_randomEngine);
+    };
+
+    auto spawnCount = std::min(size_t(count), Capacity - _count);
+
+    for (size_t i = _count; i < _count + spawnCount; ++i) {
+        auto angle = random(0.0f, 2 * Pi);
+        auto speed = random(MinSpeed, MaxSpeed);
+        auto lifetime = random(MinLifetimeMs, MaxLifetimeMs);
+
+        _positionsX[i] = float(center.x);
+        _positionsY[i] = float(center.y);
+        _velocitiesX[i] = std::cos(angle) * speed;
+        // Throw them upwards a bit more, so they arc before falling
+        _velocitiesY[i] = std::sin(angle) * speed - MinSpeed * 2;
+        _lifeLeft[i] = lifetime;
+        _inverseLifetimes[i] = 1.0f / lifetime;
+        _sizes[i] = random(MinSize, MaxSize);
+        _colors[i] = color;
+    }
+
+    _count += spawnCount;
+}
+
+void ParticleSystem::Update(float deltaTimeMs)
+{
+    auto deltaTime = deltaTimeMs;
+    auto drag = std::pow(Drag, deltaTime);
+
+    auto* positionsX = _positionsX.data();
+    auto* positionsY = _positionsY.data();
+    auto* velocitiesX = _velocitiesX.data();
+    auto* velocitiesY = _velocitiesY.data();
+    auto* lifeLeft = _lifeLeft.data();
+
+    for (size_t i = 0; i < _count; ++i) {
+        velocitiesX[i] *= drag;
+        velocitiesY[i] = velocitiesY[i] * drag + Gravity * deltaTime;
+        positionsX[i] += velocitiesX[i] * deltaTime;
+        positionsY[i] += velocitiesY[i] * deltaTime;
+        lifeLeft[i] -= deltaTime;
+    }
+
+    // The last particle is moved into the place of the dead one, so it has to be checked as well
+    for (size_t i = 0; i < _count;) {
+        if (lifeLeft[i] <= 0.0f) {
+            Kill(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void ParticleSystem::Clear()
+{
+    _count = 0;
+}
+
+size_t ParticleSystem::GetParticleCount() const
+{
+    return _count;
+}
+
+void ParticleSystem::Kill(size_t index)
+{
+    auto last = --_count;
+
+    _positionsX[index] = _positionsX[last];
+    _positionsY[index] = _positionsY[last];
+    _velocitiesX[index] = _velocitiesX[last];
+    _velocitiesY[index] = _velocitiesY[last];
+    _lifeLeft[index] = _lifeLeft[last];
+    _inverseLifetimes[index] = _inverseLifetimes[last];
+    _sizes[index] = _sizes[last];
+    _colors[index] = _colors[last];
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Vec2.h"
+
+#include <SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// What is needed to draw a particle, the color is already faded by its age
+struct ParticleSprite {
+    float X;
+    float Y;
+    float Size;
+    SDL_Color Color;
+};
+
+// A fixed number of particles, allocated once, stored in parallel arrays. Dead particles are replaced by the last live
+// one, so the live particles are always at the front and they are integrated by a loop without branches
+class ParticleSystem {
+public:
+    static constexpr size_t Capacity = 16384;
+
+    explicit ParticleSystem(unsigned int randomSeed);
+
+    // Spawns count particles flying out from the center. The ones that don't fit into the pool are dropped
+    void SpawnBurst(Vec2 center, SDL_Color color, int count);
+    void Update(float deltaTimeMs);
+    void Clear();
+
+    // visitor(float x, float y, float size, SDL_Color color) is called for every live particle, the alpha of the
+    // color is already faded by the particle's age
+    template <class Visitor>
+    void ForEach(Visitor&& visitor) const
+    {
+        for (size_t i = 0; i < _count; ++i) {
+            auto color = _colors[i];
+            color.a = Uint8(color.a * _lifeLeft[i] * _inverseLifetimes[i]);
+            visitor(_positionsX[i], _positionsY[i], _sizes[i], color);
+        }
+    }
+
+    size_t GetParticleCount() const;
+
+private:
+    static constexpr float Gravity = 0.0015f; // Pixels / ms^2
+    static constexpr float Drag = 0.998f; // The fraction of the velocity kept in every millisecond
+
+    size_t _count = 0;
+    std::vector<float> _positionsX;
+    std::vector<float> _positionsY;
+    std::vector<float> _velocitiesX;
+    std::vector<float> _velocitiesY;
+    std::vector<float> _lifeLeft; // In ms
+    std::vector<float> _inverseLifetimes;
+    std::vector<float> _sizes;
+    std::vector<SDL_Color> _colors;
+
+    std::mt19937 _randomEngine;
+
+    void Kill(size_t index);
+};
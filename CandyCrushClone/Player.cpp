@@ -1,7 +1,40 @@
 #include "Player.h"
 
+#include <cmath>
+
+namespace {
+// A flick has to move at least this far along its axis, so a twitch at the start of a slow drag doesn't switch
+constexpr int FlickMinDistance = 15;
+constexpr float FlickMinSpeed = 0.6f; // Pixels per millisecond
+// The speed along the axis of the flick has to be this many times the speed across it
+constexpr float FlickAxisRatio = 2.0f;
+
+// Returns the direction of the switch if the drag is an unambiguous flick
+std::optional<Vec2> RecognizeFlick(Vec2 offset, std::optional<DragVelocity> velocity)
+{
+    if (!velocity) {
+        return std::nullopt;
+    }
+
+    auto isHorizontal = std::abs(velocity->X) >= std::abs(velocity->Y);
+    auto alongSpeed = isHorizontal ? velocity->X : velocity->Y;
+    auto acrossSpeed = isHorizontal ? velocity->Y : velocity->X;
+    auto alongDistance = isHorizontal ? offset.x : offset.y;
+
+    // The cell has to be moving away from its place in the direction of the flick
+    if (std::abs(alongSpeed) < FlickMinSpeed || std::abs(alongSpeed) < FlickAxisRatio * std::abs(acrossSpeed)
+        || std::abs(alongDistance) < FlickMinDistance || (alongSpeed > 0) != (alongDistance > 0)) {
+        return std::nullopt;
+    }
+
+    auto step = alongSpeed > 0 ? 1 : -1;
+    return isHorizontal ? Vec2 { step, 0 } : Vec2 { 0, step };
+}
+}
+
 Player::Player(InputProcessor& inputProcessor, GameWorld& gameWorld)
     : _gameWorld(&gameWorld)
+    , _inputProcessor(&inputProcessor)
     , _mouseMoveToken(inputProcessor.MouseClicked.Subscribe([this](Vec2 position) {
         if (_gameWorld->IsInteractionEnabled()) {
             OnMouseClicked(position);
@@ -22,12 +55,52 @@ Player::Player(InputProcessor& inputProcessor, GameWorld& gameWorld)
             OnMouseDragEnded(position);
         }
     }))
-    , _tileDragCompletedToken(gameWorld.TileDragCompleted.Subscribe([this](Vec2 source) {
-        OnTileDragCompleted(source);
+    , _tileDragCompletedToken(gameWorld.TileDragCompleted.Subscribe([this](Vec2 source, bool isSwitched) {
+        OnTileDragCompleted(source, isSwitched);
     }))
 {
 }
 
+void Player::SetDragPrediction(bool isEnabled, uint32_t lookaheadMs)
+{
+    _isDragPredictionEnabled = isEnabled;
+    _dragPredictionLookaheadMs = lookaheadMs;
+}
+
+const DragPredictionStats& Player::GetDragPredictionStats() const
+{
+    return _dragPredictor.GetStats();
+}
+
+void Player::SetFlickSwitchEnabled(bool isEnabled)
+{
+    _isFlickSwitchEnabled = isEnabled;
+}
+
+const FrameTimeHistogram& Player::GetTimeToSwitchStart() const
+{
+    return _timeToSwitchStart;
+}
+
+uint32_t Player::GetFlickSwitchCount() const
+{
+    return _flickSwitchCount;
+}
+
+std::optional<Vec2> Player::GetDrawnDragPosition() const
+{
+    if (!_selectedCell || !_selectedCell->IsDragging() || _gameWorld->GetActiveCellOffset(false) != _selectedCell->Offset()) {
+        return std::nullopt;
+    }
+
+    return _selectedCell->InitialCoordinates() + *_gameWorld->GetActiveCellOffset(true);
+}
+
+uint32_t Player::GetDragStartTimestamp() const
+{
+    return _dragStartTimestampMs;
+}
+
 void Player::OnMouseClicked(Vec2 clickedCoordinates)
 {
     _draggedCell.reset();
@@ -37,35 +110,77 @@ void Player::OnMouseClicked(Vec2 clickedCoordinates)
         auto cell = _selectedCell->Index();
 
         _selectedCell.reset();
+        _inputProcessor->MarkCurrentEventVisible();
 
         if (newSelectedCell) {
             _gameWorld->TrySwitchCells(cell, *newSelectedCell);
         }
 
-    } else if (auto newSelectedCell = _gameWorld->GetTileIndicesAtPoint(clickedCoordinates)) {
+    } else if (auto newSelectedCell = _gameWorld->GetTileIndicesAtPoint(clickedCoordinates); newSelectedCell && _gameWorld->IsCellInteractable(*newSelectedCell)) {
         _selectedCell.emplace(clickedCoordinates, *newSelectedCell, *_gameWorld, false);
+        _inputProcessor->MarkCurrentEventVisible();
     }
 }
 
-void Player::OnTileDragCompleted(Vec2 source)
+void Player::OnTileDragCompleted(Vec2 source, bool isSwitched)
 {
     assert(_selectedCell->Index() == source);
 
+    if (isSwitched) {
+        _timeToSwitchStart.Add(double(_dragSampleTimestampMs - _dragStartTimestampMs));
+    }
+
     _selectedCell.reset();
 }
 
 void Player::OnMouseDragStarted(Vec2 clickedCoordinates)
 {
     auto draggedCell = _gameWorld->GetTileIndicesAtPoint(clickedCoordinates);
-    if (draggedCell) {
+    if (draggedCell && _gameWorld->IsCellInteractable(*draggedCell)) {
         _selectedCell.emplace(clickedCoordinates, *draggedCell, *_gameWorld, true);
+        _inputProcessor->MarkCurrentEventVisible();
+
+        _dragStartTimestampMs = _inputProcessor->GetCurrentEventPositionTimestamp();
+        _dragSampleTimestampMs = _dragStartTimestampMs;
+        _dragPredictor.Reset();
+        _dragPredictor.AddSample(clickedCoordinates, _dragStartTimestampMs);
     }
 }
 
-void Player::OnMouseDragMoved(Vec2 position)
+void Player::OnMouseDragMoved(Vec2)
 {
     if (_selectedCell && _selectedCell->IsDragging()) {
-        _selectedCell->UpdateBoardState(position);
+        _inputProcessor->MarkCurrentEventVisible();
+
+        // Every position of the coalesced moves is handled in order, so the switch happens at the first position that
+        // crosses the threshold, instead of at the position of the frame
+        for (const auto& sample : _inputProcessor->GetCurrentEventHistory()) {
+            _dragSampleTimestampMs = sample.TimestampMs;
+            _selectedCell->UpdateBoardState(sample.Position);
+            // The stats are collected without the prediction as well, so the two can be compared
+            _dragPredictor.AddSample(sample.Position, sample.TimestampMs);
+
+            // A switch completes the drag, then the selection is gone
+            if (!_selectedCell) {
+                return;
+            }
+
+            // The velocity is measured on the samples too, so a flick is recognized at the sample that makes it one
+            if (_isFlickSwitchEnabled) {
+                if (auto direction = RecognizeFlick(_selectedCell->Offset(), _dragPredictor.GetVelocity()); direction && _gameWorld->TrySwitchActiveCell(*direction)) {
+                    ++_flickSwitchCount;
+                }
+
+                // A refused switch completes the drag as well
+                if (!_selectedCell) {
+                    return;
+                }
+            }
+        }
+
+        if (_isDragPredictionEnabled) {
+            _gameWorld->SetActiveCellPrediction(_dragPredictor.Predict(_dragPredictionLookaheadMs), 2 * uint64_t(_dragPredictionLookaheadMs));
+        }
     }
 }
 
@@ -73,6 +188,7 @@ void Player::OnMouseDragEnded(Vec2 position)
 {
     if (_selectedCell && _selectedCell->IsDragging()) {
         _selectedCell.reset();
+        _inputProcessor->MarkCurrentEventVisible();
     }
 }
 
@@ -92,8 +208,9 @@ Player::SelectedCell::~SelectedCell()
 
 void Player::SelectedCell::UpdateBoardState(Vec2 currentPosition)
 {
-    _gameWorld.SetActiveCell(_selectedIndex, currentPosition - _initialCoordinates);
+    // Set first, a switch can destroy the selection in SetActiveCell
     _currentPosition = currentPosition;
+    _gameWorld.SetActiveCell(_selectedIndex, currentPosition - _initialCoordinates);
 }
 
 bool Player::SelectedCell::IsDragging() const
@@ -105,3 +222,13 @@ Vec2 Player::SelectedCell::Index() const
 {
     return _selectedIndex;
 }
+
+Vec2 Player::SelectedCell::Offset() const
+{
+    return _currentPosition - _initialCoordinates;
+}
+
+Vec2 Player::SelectedCell::InitialCoordinates() const
+{
+    return _initialCoordinates;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "DragPredictor.h"
+#include "FramePacer.h"
 #include "GameWorld.h"
 #include "InputProcessor.h"
 
@@ -7,6 +9,19 @@ class Player {
 public:
     Player(InputProcessor& inputProcessor, GameWorld& gameWorld);
 
+    // The dragged cell is drawn where the cursor is expected to be lookaheadMs after the last drag event
+    void SetDragPrediction(bool isEnabled, uint32_t lookaheadMs);
+    const DragPredictionStats& GetDragPredictionStats() const;
+    // A fast drag along one axis (a flick) switches the cell before it is dragged past the threshold
+    void SetFlickSwitchEnabled(bool isEnabled);
+    // The time from the start of the drags to the start of their switches, by the event timestamps
+    const FrameTimeHistogram& GetTimeToSwitchStart() const;
+    uint32_t GetFlickSwitchCount() const;
+    // Where the dragged cell is drawn, in window coordinates. nullopt while the cell doesn't follow the cursor, eg. a
+    // refused switch holds it at the threshold
+    std::optional<Vec2> GetDrawnDragPosition() const;
+    uint32_t GetDragStartTimestamp() const;
+
 private:
     struct SelectedCell {
         SelectedCell(Vec2 initialCoordinates, Vec2 selectedIndex, GameWorld& gameWorld, bool isDragging);
@@ -15,6 +30,8 @@ private:
         void UpdateBoardState(Vec2 currentPosition);
         bool IsDragging() const;
         Vec2 Index() const;
+        Vec2 Offset() const;
+        Vec2 InitialCoordinates() const;
 
     private:
         Vec2 _initialCoordinates;
@@ -25,17 +42,28 @@ private:
     };
 
     GameWorld* _gameWorld = nullptr;
-    std::unique_ptr<EventToken> _mouseMoveToken;
-    std::unique_ptr<EventToken> _mouseDragStartedToken;
-    std::unique_ptr<EventToken> _mouseDragMovedToken;
-    std::unique_ptr<EventToken> _mouseDragEndedToken;
-    std::unique_ptr<EventToken> _tileDragCompletedToken;
+    // The handled events that change the board are marked visible on it, for the latency tracking
+    InputProcessor* _inputProcessor = nullptr;
+    EventToken _mouseMoveToken;
+    EventToken _mouseDragStartedToken;
+    EventToken _mouseDragMovedToken;
+    EventToken _mouseDragEndedToken;
+    EventToken _tileDragCompletedToken;
     std::optional<Vec2> _draggedCell; // Used for mouse drag
     std::optional<SelectedCell> _selectedCell; // Used for mouse selection
+    DragPredictor _dragPredictor;
+    bool _isDragPredictionEnabled = false;
+    uint32_t _dragPredictionLookaheadMs = 0;
+    bool _isFlickSwitchEnabled = false;
+    uint32_t _dragStartTimestampMs = 0;
+    // The time of the drag position being handled, the switches are timed by it
+    uint32_t _dragSampleTimestampMs = 0;
+    FrameTimeHistogram _timeToSwitchStart;
+    uint32_t _flickSwitchCount = 0;
 
     void OnMouseDragStarted(Vec2 position);
     void OnMouseDragMoved(Vec2 position);
     void OnMouseDragEnded(Vec2 position);
     void OnMouseClicked(Vec2 position);
-    void OnTileDragCompleted(Vec2 source);
+    void OnTileDragCompleted(Vec2 source, bool isSwitched);
 };
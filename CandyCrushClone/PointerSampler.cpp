@@ -0,0 +1,112 @@
+#include "PointerSampler.h"
+
+namespace {
+uint64_t PackPosition(Vec2 position)
+{
+    return (uint64_t(uint32_t(position.x)) << 32) | uint32_t(position.y);
+}
+
+Vec2 UnpackPosition(uint64_t packed)
+{
+    return Vec2 { int32_t(uint32_t(packed >> 32)), int32_t(uint32_t(packed)) };
+}
+}
+
+SDL_Event ToMouseMotionEvent(const PointerSample& sample)
+{
+    SDL_Event e {};
+    e.type = SDL_MOUSEMOTION;
+    e.motion.timestamp = sample.TimestampMs;
+    e.motion.state = sample.ButtonMask;
+    e.motion.x = sample.Position.x;
+    e.motion.y = sample.Position.y;
+
+    return e;
+}
+
+PointerSampler::PointerSampler(Vec2 windowPosition)
+    : _windowPosition(PackPosition(windowPosition))
+{
+    _thread = std::thread([this] { Run(); });
+}
+
+PointerSampler::~PointerSampler()
+{
+    _shouldStop = true;
+    _thread.join();
+}
+
+void PointerSampler::HandleWindowEvent(const SDL_WindowEvent& e)
+{
+    switch (e.event) {
+    case SDL_WINDOWEVENT_MOVED: {
+        _windowPosition = PackPosition(Vec2 { e.data1, e.data2 });
+    } break;
+    case SDL_WINDOWEVENT_FOCUS_GAINED:
+    case SDL_WINDOWEVENT_FOCUS_LOST: {
+        _hasFocus = e.event == SDL_WINDOWEVENT_FOCUS_GAINED;
+    } break;
+    case SDL_WINDOWEVENT_ENTER:
+    case SDL_WINDOWEVENT_LEAVE: {
+        _hasCursor = e.event == SDL_WINDOWEVENT_ENTER;
+    } break;
+    default:
+        break;
+    }
+
+    _isPaused = !_hasFocus || !_hasCursor;
+}
+
+bool PointerSampler::IsPaused() const
+{
+    return _isPaused;
+}
+
+bool PointerSampler::TryPopSample(std::optional<uint32_t> untilTimestampMs, PointerSample& sample)
+{
+    if (!_nextSample) {
+        PointerSample popped;
+        if (!_samples.TryPop(popped)) {
+            return false;
+        }
+
+        _nextSample = popped;
+    }
+
+    // The unsigned difference handles the wrap around of the 32 bit timestamps
+    if (untilTimestampMs && int32_t(_nextSample->TimestampMs - *untilTimestampMs) > 0) {
+        return false;
+    }
+
+    sample = *_nextSample;
+    _nextSample.reset();
+    return true;
+}
+
+void PointerSampler::Run()
+{
+    std::optional<PointerSample> previous;
+
+    while (!_shouldStop) {
+        if (_isPaused) {
+            // The first sample after the pause is passed on even if the mouse is back where it was
+            previous.reset();
+            SDL_Delay(1);
+            continue;
+        }
+
+        int x = 0, y = 0;
+        auto buttonMask = SDL_GetGlobalMouseState(&x, &y);
+
+        PointerSample sample { Vec2 { x, y } - UnpackPosition(_windowPosition), buttonMask, uint32_t(SDL_GetTicks64()) };
+        // Only the changes are passed on. If the game thread stopped draining the ring, the samples are dropped
+        if (!previous || previous->Position != sample.Position || previous->ButtonMask != sample.ButtonMask) {
+            if (_samples.TryPush(sample)) {
+                previous = sample;
+            }
+        }
+
+        // SDL asks for a 1 ms timer resolution, so this wakes up about every millisecond
+        SDL_Delay(1);
+    }
+}
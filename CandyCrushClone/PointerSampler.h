@@ -0,0 +1,62 @@
+#pragma once
+
+#include "SpscQueue.h"
+#include "Vec2.h"
+
+#include <SDL.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <thread>
+
+// The state of the mouse at a moment, in window coordinates
+struct PointerSample {
+    Vec2 Position;
+    uint32_t ButtonMask; // SDL_BUTTON_LMASK etc.
+    uint32_t TimestampMs; // Comparable to the SDL event timestamps
+};
+
+// The sample as a motion event, so it can be handled and recorded like the motion events of SDL
+SDL_Event ToMouseMotionEvent(const PointerSample& sample);
+
+// Reads the mouse state about every millisecond on its own thread, and passes the changed states to the game thread
+// through a lock-free ring. SDL only pumps the events on the thread of the window, so the global mouse state is read
+// instead, which is converted to window coordinates with the window position set by the main thread.
+// The sampling is paused while the window doesn't have the focus or the cursor, the motion events of SDL are used then
+class PointerSampler {
+public:
+    PointerSampler(Vec2 windowPosition);
+    ~PointerSampler();
+
+    PointerSampler(const PointerSampler&) = delete;
+    PointerSampler& operator=(const PointerSampler&) = delete;
+
+    // Main thread: follows the position of the window, and pauses the sampling while the window doesn't have the focus
+    // or the cursor
+    void HandleWindowEvent(const SDL_WindowEvent& e);
+    // The motion events of SDL have to be used while the sampling is paused
+    bool IsPaused() const;
+
+    // Game thread: pops the next sample that was taken at or before the given time, or any sample without a time
+    bool TryPopSample(std::optional<uint32_t> untilTimestampMs, PointerSample& sample);
+
+private:
+    static constexpr size_t SampleQueueCapacity = 4096;
+
+    SpscQueue<PointerSample, SampleQueueCapacity> _samples;
+    // Popped already, but it is newer than what was asked for
+    std::optional<PointerSample> _nextSample;
+
+    // Both coordinates in one word, so the sampler never reads the x of one position with the y of another
+    std::atomic<uint64_t> _windowPosition;
+    std::atomic<bool> _isPaused = false;
+    // Only used on the main thread
+    bool _hasFocus = true;
+    bool _hasCursor = true;
+    std::atomic<bool> _shouldStop = false;
+    std::thread _thread;
+
+    void Run();
+};
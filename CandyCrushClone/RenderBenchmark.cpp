@@ -0,0 +1,361 @@
+#include "RenderBenchmark.h"
+
+#include "AudioPlayer.h"
+#include "GameState.h"
+#include "GameWorld.h"
+#include "InputProcessor.h"
+#include "MainMenu.h"
+
+#include <SDL.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+static constexpr const char* const BlitterSceneSuffix = "+blitter";
+
+using GoldenHashes = std::unordered_map<std::string, std::vector<uint64_t>>;
+
+// Every line of the golden file looks like this: <scene name> <frame index> <frame hash in hex>
+// Returns nullopt if the file can't be opened
+std::optional<GoldenHashes> ReadGoldenHashes(const std::string& filePath)
+{
+    std::ifstream inStream { filePath };
+    if (!inStream) {
+        return std::nullopt;
+    }
+
+    GoldenHashes goldenHashes;
+
+    std::string sceneName;
+    size_t frameIndex;
+    uint64_t hash;
+    while (inStream >> sceneName >> frameIndex >> std::hex >> hash >> std::dec) {
+        auto& hashes = goldenHashes[sceneName];
+        if (hashes.size() <= frameIndex) {
+            hashes.resize(frameIndex + 1);
+        }
+
+        hashes[frameIndex] = hash;
+    }
+
+    return goldenHashes;
+}
+
+bool WriteGoldenHashes(const std::string& filePath, const GoldenHashes& goldenHashes)
+{
+    std::ofstream outStream { filePath };
+
+    for (const auto& [sceneName, hashes] : goldenHashes) {
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            outStream << sceneName << " " << i << " " << std::hex << hashes[i] << std::dec << "\n";
+        }
+    }
+
+    return bool(outStream);
+}
+
+SDL_Event MakeMouseMotionEvent(Vec2 position)
+{
+    SDL_Event event {};
+    event.type = SDL_MOUSEMOTION;
+    event.motion.x = position.x;
+    event.motion.y = position.y;
+
+    return event;
+}
+}
+
+RenderBenchmark::RenderBenchmark(Screen& screen)
+    : _screen(&screen)
+{
+}
+
+int RenderBenchmark::Run(const std::string& goldenFilePath, bool updateGoldenFile, const std::optional<std::string>& frameDumpDirectory)
+{
+    // Without the golden file every frame would be a mismatch, fail before rendering instead
+    auto goldenHashes = updateGoldenFile ? std::optional<GoldenHashes> { GoldenHashes {} } : ReadGoldenHashes(goldenFilePath);
+    if (!goldenHashes) {
+        std::cerr << "Failed to read the golden hashes from " << goldenFilePath << ", run with --update-golden to create them" << std::endl;
+        return 1;
+    }
+
+    if (frameDumpDirectory) {
+        std::filesystem::create_directories(*frameDumpDirectory);
+    }
+
+    struct Variant {
+        std::string Suffix;
+        bool UseSoftwareBlitter;
+        int ThreadCount;
+    };
+
+    // The tiled rasterizer produces the same frames regardless of the thread count, so the variants share the goldens
+    std::vector<Variant> variants { { "", false, 0 }, { BlitterSceneSuffix, true, 1 } };
+    if (auto hardwareThreadCount = int(std::thread::hardware_concurrency()); hardwareThreadCount > 1) {
+        variants.push_back({ std::string(BlitterSceneSuffix) + "/" + std::to_string(hardwareThreadCount) + "t", true, hardwareThreadCount });
+    }
+
+    std::vector<SceneResult> results;
+
+    for (const auto& variant : variants) {
+        _screen->SetSoftwareBlitterEnabled(variant.UseSoftwareBlitter, variant.ThreadCount);
+        auto goldenSuffix = variant.UseSoftwareBlitter ? BlitterSceneSuffix : "";
+
+        for (const auto& result : { RunMenuScene("menu" + variant.Suffix, frameDumpDirectory),
+                 RunBoardIdleScene("boardidle" + variant.Suffix, frameDumpDirectory),
+                 RunCascadeScene("cascade" + variant.Suffix, frameDumpDirectory),
+                 RunScaledCellsScene("scaledcells" + variant.Suffix, frameDumpDirectory),
+                 RunParticlesScene("particles" + variant.Suffix, frameDumpDirectory) }) {
+            results.push_back(result);
+            results.back().GoldenName = result.Name.substr(0, result.Name.size() - variant.Suffix.size()) + goldenSuffix;
+        }
+    }
+
+    // The SDL renderer and the single threaded blitter again, but now every scaled cell is resampled from the original image
+    std::vector<std::pair<size_t, size_t>> prescaledAndResampledResultIndices;
+    _screen->SetPrescaledCellsEnabled(false);
+
+    for (size_t variantIndex = 0; variantIndex < 2; ++variantIndex) {
+        const auto& variant = variants[variantIndex];
+        _screen->SetSoftwareBlitterEnabled(variant.UseSoftwareBlitter, variant.ThreadCount);
+
+        results.push_back(RunScaledCellsScene("scaledcells-resampled" + variant.Suffix, frameDumpDirectory));
+        results.back().GoldenName = std::string("scaledcells-resampled") + (variant.UseSoftwareBlitter ? BlitterSceneSuffix : "");
+        prescaledAndResampledResultIndices.emplace_back(variantIndex * SceneCount + ScaledCellsSceneIndex, results.size() - 1);
+    }
+
+    _screen->SetPrescaledCellsEnabled(true);
+
+    if (const auto* blitter = _screen->GetSoftwareBlitter()) {
+        std::cout << "Software blitter uses " << blitter->GetImplementationName() << std::endl;
+    }
+
+    _screen->SetSoftwareBlitterEnabled(false);
+
+    int totalMismatchCount = 0;
+
+    for (const auto& result : results) {
+        int mismatchCount = 0;
+        std::optional<size_t> firstMismatch;
+
+        if (updateGoldenFile) {
+            goldenHashes->try_emplace(result.GoldenName, result.FrameHashes);
+        }
+
+        const auto& expectedHashes = (*goldenHashes)[result.GoldenName];
+        for (size_t i = 0; i < result.FrameHashes.size(); ++i) {
+            if (i >= expectedHashes.size() || expectedHashes[i] != result.FrameHashes[i]) {
+                ++mismatchCount;
+                firstMismatch = firstMismatch.value_or(i);
+            }
+        }
+
+        totalMismatchCount += mismatchCount;
+
+        std::cout << std::left << std::setw(22) << result.Name << std::right
+                  << result.FrameHashes.size() << " frames in " << std::fixed << std::setprecision(3) << result.ElapsedSeconds << " s ("
+                  << std::setprecision(1) << result.FrameHashes.size() / result.ElapsedSeconds << " fps), "
+                  << mismatchCount << " golden hash mismatches";
+
+        if (firstMismatch) {
+            std::cout << ", first at frame " << *firstMismatch;
+        }
+
+        std::cout << std::endl;
+    }
+
+    // Compare every variant to the SDL renderer, which always comes first
+    for (size_t variantIndex = 1; variantIndex < variants.size(); ++variantIndex) {
+        for (size_t sceneIndex = 0; sceneIndex < SceneCount; ++sceneIndex) {
+            const auto& rendererResult = results[sceneIndex];
+            const auto& variantResult = results[variantIndex * SceneCount + sceneIndex];
+
+            std::cout << variantResult.Name << " speedup over the SDL renderer: "
+                      << std::setprecision(2) << rendererResult.ElapsedSeconds / variantResult.ElapsedSeconds << "x" << std::endl;
+        }
+    }
+
+    for (const auto& [prescaledIndex, resampledIndex] : prescaledAndResampledResultIndices) {
+        const auto& prescaledResult = results[prescaledIndex];
+        const auto& resampledResult = results[resampledIndex];
+        auto prescaledFrameTimeMs = prescaledResult.ElapsedSeconds * 1000.0 / prescaledResult.FrameHashes.size();
+        auto resampledFrameTimeMs = resampledResult.ElapsedSeconds * 1000.0 / resampledResult.FrameHashes.size();
+
+        std::cout << prescaledResult.Name << ": " << std::setprecision(3) << prescaledFrameTimeMs << " ms per frame with prescaled cells, "
+                  << resampledFrameTimeMs << " ms when resampling (" << std::setprecision(1)
+                  << (1.0 - prescaledFrameTimeMs / resampledFrameTimeMs) * 100.0 << "% less)" << std::endl;
+    }
+
+    if (updateGoldenFile) {
+        if (!WriteGoldenHashes(goldenFilePath, *goldenHashes)) {
+            std::cerr << "Failed to write the golden hashes to " << goldenFilePath << std::endl;
+            return 1;
+        }
+
+        std::cout << "Golden hashes written to " << goldenFilePath << std::endl;
+    }
+
+    return totalMismatchCount;
+}
+
+RenderBenchmark::SceneResult RenderBenchmark::RunScene(const std::string& name, const std::function<void(int frameIndex)>& drawFrame, const std::optional<std::string>& frameDumpDirectory)
+{
+    SceneResult result { name, name, {}, 0.0 };
+    result.FrameHashes.reserve(FramesPerScene);
+
+    uint64_t elapsedTicks = 0;
+
+    for (int i = 0; i < FramesPerScene; ++i) {
+        auto frameStart = SDL_GetPerformanceCounter();
+        drawFrame(i);
+        _screen->Present();
+        elapsedTicks += SDL_GetPerformanceCounter() - frameStart;
+
+        // Hashing and saving the frames are not part of the measured frame time
+        result.FrameHashes.push_back(_screen->GetFrameHash());
+
+        if (frameDumpDirectory) {
+            std::ostringstream fileName;
+            fileName << name << "_" << std::setw(4) << std::setfill('0') << i << ".png";
+            _screen->SaveFrame((std::filesystem::path(*frameDumpDirectory) / fileName.str()).string());
+        }
+    }
+
+    result.ElapsedSeconds = double(elapsedTicks) / SDL_GetPerformanceFrequency();
+
+    return result;
+}
+
+RenderBenchmark::SceneResult RenderBenchmark::RunMenuScene(const std::string& name, const std::optional<std::string>& frameDumpDirectory)
+{
+    InputProcessor inputProcessor;
+    MainMenu menu { *_screen, inputProcessor };
+    menu.Activate(true, { "Benchmarking the main menu" });
+
+    return RunScene(
+        name, [&](int frameIndex) {
+            // Sweep the mouse over the buttons, so the hover state changes as well
+            inputProcessor.ProcessMouseEvent(MakeMouseMotionEvent(Vec2 { Screen::ScreenWidth / 2, (frameIndex * 7) % Screen::ScreenHeight }));
+            inputProcessor.DispatchQueuedEvents();
+
+            if (frameIndex == FramesPerScene / 2) {
+                menu.ShowLeaderboard({ 20000, 30000, 40000, 50000, 60000 }, { 90000, 80000, 70000 });
+            }
+
+            _drawList.Clear();
+            menu.Draw(_drawList);
+
+            _screen->BeginFrame();
+            _drawList.Execute(*_screen);
+        },
+        frameDumpDirectory);
+}
+
+RenderBenchmark::SceneResult RenderBenchmark::RunBoardIdleScene(const std::string& name, const std::optional<std::string>& frameDumpDirectory)
+{
+    AudioPlayer audioPlayer { RandomSeed };
+    ClassicGameState gameState;
+    GameWorld gameWorld { 8, 8, 5, *_screen, audioPlayer, RandomSeed };
+    gameWorld.Activate(gameState);
+
+    return RunScene(
+        name, [&](int) {
+            gameWorld.Update(FrameTimeMs);
+
+            _drawList.Clear();
+            gameWorld.Draw(_drawList);
+
+            _screen->BeginFrame();
+            _drawList.Execute(*_screen);
+        },
+        frameDumpDirectory);
+}
+
+RenderBenchmark::SceneResult RenderBenchmark::RunCascadeScene(const std::string& name, const std::optional<std::string>& frameDumpDirectory)
+{
+    AudioPlayer audioPlayer { RandomSeed };
+    ClassicGameState gameState;
+    GameWorld gameWorld { 8, 8, 5, *_screen, audioPlayer, RandomSeed };
+    gameWorld.Activate(gameState);
+
+    return RunScene(
+        name, [&](int) {
+            gameWorld.Update(FrameTimeMs);
+
+            // Start a new switch as soon as the previous cascade has finished, so there is always something animating
+            if (gameWorld.IsInteractionEnabled()) {
+                if (auto cellsToSwitch = gameWorld.FindValidSwitch()) {
+                    gameWorld.TrySwitchCells(cellsToSwitch->first, cellsToSwitch->second);
+                }
+            }
+
+            _drawList.Clear();
+            gameWorld.Draw(_drawList);
+
+            _screen->BeginFrame();
+            _drawList.Execute(*_screen);
+        },
+        frameDumpDirectory);
+}
+
+RenderBenchmark::SceneResult RenderBenchmark::RunScaledCellsScene(const std::string& name, const std::optional<std::string>& frameDumpDirectory)
+{
+    static constexpr int CellSize = 70;
+    static constexpr int BoardSize = 8;
+
+    return RunScene(
+        name, [&](int frameIndex) {
+            _screen->BeginFrame();
+
+            // A whole board of cells, each of them with a different size in every frame, like the destroy and the active cell animations
+            for (int i = 0; i < BoardSize; ++i) {
+                for (int j = 0; j < BoardSize; ++j) {
+                    auto size = 1 + (frameIndex + i * 7 + j * 13) % Screen::MaxPrescaledCellSize;
+                    auto offset = (CellSize - size) / 2;
+
+                    _screen->DrawCell(Vec2 { i * CellSize + offset, j * CellSize + offset }, (i + j) % 5, CellSize, size);
+                }
+            }
+        },
+        frameDumpDirectory);
+}
+
+RenderBenchmark::SceneResult RenderBenchmark::RunParticlesScene(const std::string& name, const std::optional<std::string>& frameDumpDirectory)
+{
+    static constexpr int BurstsPerFrame = 8;
+    static constexpr int ParticlesPerBurst = 60;
+    static constexpr int CellTypeCount = 5;
+
+    ParticleSystem particles { RandomSeed };
+    size_t maxParticleCount = 0;
+
+    auto result = RunScene(
+        name, [&](int frameIndex) {
+            // Spread the bursts over the board, in every frame somewhere else
+            for (int i = 0; i < BurstsPerFrame; ++i) {
+                auto burstIndex = frameIndex * BurstsPerFrame + i;
+                auto center = Vec2 { 35 + (burstIndex * 7 % 8) * 70, 35 + (burstIndex * 3 % 8) * 70 };
+                particles.SpawnBurst(center, _screen->GetCellColor(burstIndex % CellTypeCount), ParticlesPerBurst);
+            }
+
+            particles.Update(FrameTimeMs);
+            maxParticleCount = std::max(maxParticleCount, particles.GetParticleCount());
+
+            _drawList.Clear();
+            _drawList.DrawParticles(particles);
+
+            _screen->BeginFrame();
+            _drawList.Execute(*_screen);
+        },
+        frameDumpDirectory);
+
+    std::cout << name << ": at most " << maxParticleCount << " live particles" << std::endl;
+
+    return result;
+}
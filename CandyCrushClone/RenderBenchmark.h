@@ -0,0 +1,48 @@
+#pragma once
+
+#include "DrawList.h"
+#include "Screen.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Replays a few fixed scenes with a fixed time step on an offscreen screen, so the results are reproducible.
+// Prints the achieved frames per second and compares every frame's hash to the golden hashes.
+// Every scene is run with the SDL renderer and with the software blitter using 1 and all hardware threads.
+// The scaled cells scene is run once more without the prescaled cell images, to show the cost of resampling.
+// The particles scene keeps the particle pool nearly full, like a large combo does
+class RenderBenchmark {
+public:
+    explicit RenderBenchmark(Screen& screen);
+
+    // Returns the number of frames that didn't match the golden hashes. A missing golden file fails the run unless
+    // updateGoldenFile is set, and so does a failed write
+    int Run(const std::string& goldenFilePath, bool updateGoldenFile, const std::optional<std::string>& frameDumpDirectory);
+
+private:
+    static constexpr int FramesPerScene = 600;
+    static constexpr uint64_t FrameTimeMs = 16;
+    static constexpr unsigned int RandomSeed = 1234;
+    static constexpr size_t SceneCount = 5;
+    static constexpr size_t ScaledCellsSceneIndex = 3;
+
+    struct SceneResult {
+        std::string Name;
+        std::string GoldenName;
+        std::vector<uint64_t> FrameHashes;
+        double ElapsedSeconds = 0.0;
+    };
+
+    Screen* _screen;
+    // The scenes record their frames like the game does, then execute them on the screen
+    DrawList _drawList;
+
+    SceneResult RunScene(const std::string& name, const std::function<void(int frameIndex)>& drawFrame, const std::optional<std::string>& frameDumpDirectory);
+    SceneResult RunMenuScene(const std::string& name, const std::optional<std::string>& frameDumpDirectory);
+    SceneResult RunBoardIdleScene(const std::string& name, const std::optional<std::string>& frameDumpDirectory);
+    SceneResult RunCascadeScene(const std::string& name, const std::optional<std::string>& frameDumpDirectory);
+    SceneResult RunScaledCellsScene(const std::string& name, const std::optional<std::string>& frameDumpDirectory);
+    SceneResult RunParticlesScene(const std::string& name, const std::optional<std::string>& frameDumpDirectory);
+};
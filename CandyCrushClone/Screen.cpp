@@ -4,6 +4,8 @@
 #include <SDL_ttf.h>
 
 #include <array>
+#include <cassert>
+#include <functional>
 #include <iostream>
 
 namespace {
@@ -22,10 +24,68 @@ static constexpr const char* FontPath = "Assets/OpenSans.ttf";
 static constexpr const char* BoldFontPath = "Assets/OpenSans-Bold.ttf";
 static constexpr const char* MenuButtonImagePath = "Assets/MenuButton.png";
 
+// Calls the callback with the image scaled to every size between 1 and maxSize (inclusive), in increasing order
+bool ForEachScaledImage(const std::string& filePath, int maxSize, const std::function<bool(SDL_Surface* scaledSurface)>& callback)
+{
+    SDL_Surface* loadedSurface = IMG_Load(filePath.c_str());
+    if (!loadedSurface) {
+        std::cerr << "Failed to load image. SDL_image Error: " << IMG_GetError() << std::endl;
+        return false;
+    }
+
+    // Linear stretching only works between surfaces with the same 32 bit format
+    SDL_Surface* sourceSurface = SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loadedSurface);
+
+    bool isSuccessful = sourceSurface != nullptr;
+
+    for (int size = 1; size <= maxSize && isSuccessful; ++size) {
+        SDL_Surface* scaledSurface = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+        isSuccessful = scaledSurface && SDL_SoftStretchLinear(sourceSurface, nullptr, scaledSurface, nullptr) == 0 && callback(scaledSurface);
+        SDL_FreeSurface(scaledSurface);
+    }
+
+    if (!isSuccessful) {
+        std::cerr << "Failed to scale image " << filePath << ". SDL Error: " << SDL_GetError() << std::endl;
+    }
+
+    SDL_FreeSurface(sourceSurface);
+
+    return isSuccessful;
+}
+
+// The average color of the mostly opaque pixels of an ARGB8888 surface
+SDL_Color GetAverageColor(SDL_Surface* surface)
+{
+    uint64_t red = 0, green = 0, blue = 0, count = 0;
+
+    for (int y = 0; y < surface->h; ++y) {
+        const auto* row = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(surface->pixels) + y * surface->pitch);
+        for (int x = 0; x < surface->w; ++x) {
+            if ((row[x] >> 24) > 128) {
+                red += (row[x] >> 16) & 0xFF;
+                green += (row[x] >> 8) & 0xFF;
+                blue += row[x] & 0xFF;
+                ++count;
+            }
+        }
+    }
+
+    if (count == 0) {
+        return SDL_Color { 255, 255, 255, 255 };
+    }
+
+    return SDL_Color { Uint8(red / count), Uint8(green / count), Uint8(blue / count), 255 };
+}
 }
 
 bool Screen::Initialize()
 {
+    if (_mode == Mode::Offscreen) {
+        // We still need the event subsystem, but we don't want to open a window on a real display
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         TerminateWithMessage(std::string("SDL could not initialize! SDL_Error: ") + SDL_GetError());
         return false;
@@ -37,13 +97,24 @@ bool Screen::Initialize()
         return false;
     }
 
-    _window = SDL_CreateWindow("Jewels clone", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, ScreenWidth, ScreenHeight, SDL_WINDOW_SHOWN);
-    if (!_window) {
-        TerminateWithMessage(std::string("Window could not be created! SDL_Error: ") + SDL_GetError());
-        return false;
+    if (_mode == Mode::Offscreen) {
+        _offscreenSurface = SDL_CreateRGBSurfaceWithFormat(0, ScreenWidth, ScreenHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!_offscreenSurface) {
+            TerminateWithMessage(std::string("Offscreen surface could not be created! SDL_Error: ") + SDL_GetError());
+            return false;
+        }
+
+        _renderer = SDL_CreateSoftwareRenderer(_offscreenSurface);
+    } else {
+        _window = SDL_CreateWindow("Jewels clone", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, ScreenWidth, ScreenHeight, SDL_WINDOW_SHOWN);
+        if (!_window) {
+            TerminateWithMessage(std::string("Window could not be created! SDL_Error: ") + SDL_GetError());
+            return false;
+        }
+
+        _renderer = SDL_CreateRenderer(_window, -1, 0);
     }
 
-    _renderer = SDL_CreateRenderer(_window, -1, 0);
     if (!_renderer) {
         TerminateWithMessage(std::string("SDL renderer could not be created! SDL_Error: ") + SDL_GetError());
         return false;
@@ -64,6 +135,8 @@ bool Screen::Initialize()
 
 void Screen::TerminateWithMessage(const std::string& errorText)
 {
+    // There might be no one to click on the message box, so always leave a trace on the console as well
+    std::cerr << errorText << std::endl;
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "An error occurred while running the application.", errorText.c_str(), _window);
     std::terminate();
 }
@@ -78,8 +151,26 @@ bool Screen::LoadAssets()
         }
 
         _assetImages.push_back(std::move(image));
+
+        auto& prescaledImages = _prescaledCellImages.emplace_back();
+        prescaledImages.reserve(MaxPrescaledCellSize);
+
+        bool isSuccessful = ForEachScaledImage(assetName, MaxPrescaledCellSize, [this, &prescaledImages](SDL_Surface* scaledSurface) {
+            if (scaledSurface->w == MaxPrescaledCellSize) {
+                _cellColors.push_back(GetAverageColor(scaledSurface));
+            }
+
+            prescaledImages.emplace_back(SDL_CreateTextureFromSurface(_renderer, scaledSurface));
+            return bool(prescaledImages.back());
+        });
+
+        if (!isSuccessful) {
+            return false;
+        }
     }
 
+    SDL_QueryTexture(*_assetImages[0], nullptr, nullptr, &_cellImageSize, nullptr);
+
     _backgroundImage = LoadImage(BackgroundImagePath);
     _menuButton = LoadImage(MenuButtonImagePath);
 
@@ -92,9 +183,11 @@ bool Screen::LoadAssets()
     return true;
 }
 
-std::unique_ptr<Screen> Screen::GetScreen()
+std::unique_ptr<Screen> Screen::GetScreen(Mode mode)
 {
     auto screen = std::make_unique<Screen>();
+    screen->_mode = mode;
+
     if (screen->Initialize() && screen->LoadAssets()) {
         return screen;
     }
@@ -106,6 +199,7 @@ Screen::~Screen()
 {
     SDL_DestroyRenderer(_renderer);
 
+    SDL_FreeSurface(_offscreenSurface);
     SDL_DestroyWindow(_window);
     SDL_Quit();
 
@@ -113,38 +207,298 @@ Screen::~Screen()
     TTF_CloseFont(_bigFont);
 }
 
+bool Screen::LoadBlitterAssets()
+{
+    for (const auto& assetName : AssetNames) {
+        auto image = SoftwareBlitter::LoadImage(assetName);
+        if (!image) {
+            return false;
+        }
+
+        _blitterAssetImages.push_back(std::move(*image));
+
+        auto& prescaledImages = _blitterPrescaledCellImages.emplace_back();
+        prescaledImages.reserve(MaxPrescaledCellSize);
+
+        bool isSuccessful = ForEachScaledImage(assetName, MaxPrescaledCellSize, [&prescaledImages](SDL_Surface* scaledSurface) {
+            auto scaledImage = SoftwareBlitter::MakeImage(scaledSurface);
+            if (scaledImage) {
+                prescaledImages.push_back(std::move(*scaledImage));
+            }
+
+            return scaledImage.has_value();
+        });
+
+        if (!isSuccessful) {
+            return false;
+        }
+    }
+
+    for (const auto& framePath : SpriteAnimation::GetFramePaths(SpriteAnimationDirectory)) {
+        auto image = SoftwareBlitter::LoadImage(framePath);
+        if (!image) {
+            return false;
+        }
+
+        _blitterAnimationFrames.push_back(std::move(*image));
+    }
+
+    // The background always covers the whole screen, so it can be scaled in advance
+    auto backgroundImage = SoftwareBlitter::LoadImage(BackgroundImagePath, SDL_Point { ScreenWidth, ScreenHeight });
+    if (!backgroundImage) {
+        return false;
+    }
+
+    _blitterBackgroundImage = std::move(*backgroundImage);
+
+    auto menuButtonImage = SoftwareBlitter::LoadImage(MenuButtonImagePath);
+    if (!menuButtonImage) {
+        return false;
+    }
+
+    _blitterMenuButtonImage = std::move(*menuButtonImage);
+
+    return true;
+}
+
+bool Screen::SetVsyncEnabled(bool isEnabled)
+{
+    if (SDL_RenderSetVSync(_renderer, isEnabled ? 1 : 0) != 0) {
+        std::cerr << "Failed to change vsync. SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+std::optional<Vec2> Screen::GetWindowPosition() const
+{
+    if (_mode != Mode::Windowed) {
+        return std::nullopt;
+    }
+
+    Vec2 position;
+    SDL_GetWindowPosition(_window, &position.x, &position.y);
+    return position;
+}
+
+void Screen::SetSoftwareBlitterEnabled(bool isEnabled, int threadCount)
+{
+    if (!isEnabled) {
+        _blitter.reset();
+        return;
+    }
+
+    if (_blitterAssetImages.empty() && !LoadBlitterAssets()) {
+        std::cerr << "Failed to load the images for the software blitter, falling back to the SDL renderer" << std::endl;
+        return;
+    }
+
+    if (!_blitterTexture) {
+        _blitterTexture = Texture { SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, ScreenWidth, ScreenHeight) };
+        if (!_blitterTexture) {
+            std::cerr << "Failed to create the texture for the software blitter. SDL_Error: " << SDL_GetError() << std::endl;
+            return;
+        }
+    }
+
+    _blitter = std::make_unique<SoftwareBlitter>(ScreenWidth, ScreenHeight, threadCount);
+}
+
+bool Screen::IsSoftwareBlitterEnabled() const
+{
+    return _blitter != nullptr;
+}
+
+const SoftwareBlitter* Screen::GetSoftwareBlitter() const
+{
+    return _blitter.get();
+}
+
+bool Screen::IsBlitterDrawing() const
+{
+    return _blitter && !_isBlitterFlushed;
+}
+
+void Screen::FlushBlitter() const
+{
+    if (!IsBlitterDrawing()) {
+        return;
+    }
+
+    _blitter->Rasterize();
+
+    SDL_UpdateTexture(*_blitterTexture, nullptr, _blitter->GetPixels(), _blitter->GetPitch());
+    SDL_RenderCopy(_renderer, *_blitterTexture, nullptr, nullptr);
+
+    // Anything that is drawn after this point in the frame goes through the SDL renderer, so it ends up on top
+    _isBlitterFlushed = true;
+}
+
+const BlitterImage* Screen::GetBlitterTextImage(const std::string& text, bool useLargeFont, SDL_Color color) const
+{
+    std::string key;
+    key.reserve(text.size() + 5);
+    key.push_back(useLargeFont ? 'L' : 'S');
+    key.append({ char(color.r), char(color.g), char(color.b), char(color.a) });
+    key.append(text);
+
+    auto cachedTextIt = _blitterTextCache.find(key);
+    if (cachedTextIt == _blitterTextCache.end()) {
+        SDL_Surface* textSurface = TTF_RenderText_Solid(useLargeFont ? _bigFont : _smallFont, text.c_str(), color);
+        if (!textSurface) {
+            std::cerr << "Something went wrong: " << TTF_GetError() << std::endl;
+            return nullptr;
+        }
+
+        auto image = SoftwareBlitter::MakeImage(textSurface);
+        SDL_FreeSurface(textSurface);
+
+        if (!image) {
+            std::cerr << "Something went wrong: " << SDL_GetError() << std::endl;
+            return nullptr;
+        }
+
+        cachedTextIt = _blitterTextCache.emplace(std::move(key), CachedText { std::move(*image) }).first;
+    }
+
+    cachedTextIt->second.LastUsedFrame = _frameIndex;
+
+    return &cachedTextIt->second.Image;
+}
+
 void Screen::BeginFrame() const
 {
+    ++_frameIndex;
+
+    if (_blitter) {
+        // Every text that was drawn in the previous frame is already rasterized, so it's safe to remove the unused ones
+        std::erase_if(_blitterTextCache, [this](const auto& entry) { return entry.second.LastUsedFrame + 1 < _frameIndex; });
+
+        _blitter->Copy(_blitterBackgroundImage);
+        _isBlitterFlushed = false;
+        return;
+    }
+
     SDL_RenderClear(_renderer);
     SDL_Rect entireScreen { 0, 0, ScreenWidth, ScreenHeight };
     SDL_RenderCopy(_renderer, *_backgroundImage, nullptr, &entireScreen);
 }
 
+void Screen::SetPrescaledCellsEnabled(bool isEnabled)
+{
+    _usePrescaledCells = isEnabled;
+}
+
+bool Screen::CanUsePrescaledCell(int sourceSize, int destinationSize) const
+{
+    return _usePrescaledCells && sourceSize == _cellImageSize && destinationSize <= MaxPrescaledCellSize;
+}
+
 void Screen::DrawCell(Vec2 coords, int cellType, int sourceSize, int destinationSize) const
 {
-    SDL_Rect srcRect { 0, 0, sourceSize, sourceSize };
+    if (destinationSize <= 0) {
+        return;
+    }
+
     SDL_Rect dstRect { coords.x, coords.y, destinationSize, destinationSize };
+    bool usePrescaledCell = CanUsePrescaledCell(sourceSize, destinationSize);
+
+    if (IsBlitterDrawing()) {
+        _blitter->Blit(usePrescaledCell ? _blitterPrescaledCellImages[cellType][destinationSize - 1] : _blitterAssetImages[cellType], dstRect);
+        return;
+    }
+
+    if (usePrescaledCell) {
+        SDL_RenderCopy(_renderer, *_prescaledCellImages[cellType][destinationSize - 1], nullptr, &dstRect);
+        return;
+    }
+
+    SDL_Rect srcRect { 0, 0, sourceSize, sourceSize };
     SDL_RenderCopy(_renderer, *_assetImages[cellType], &srcRect, &dstRect);
 }
 
 void Screen::DrawDestroyAnimation(Vec2 coords, int size, double progress)
 {
+    if (IsBlitterDrawing()) {
+        _blitter->Blit(_blitterAnimationFrames[_gravityAnimation->GetFrameIndex(progress)], SDL_Rect { coords.x, coords.y, size, size });
+        return;
+    }
+
     _gravityAnimation->Draw(coords, size, progress);
 }
 
+void Screen::DrawParticles(std::span<const ParticleSprite> particles) const
+{
+    if (IsBlitterDrawing()) {
+        for (const auto& [x, y, size, color] : particles) {
+            _blitter->FillRect(SDL_Rect { int(x - size / 2), int(y - size / 2), int(size), int(size) }, color);
+        }
+
+        return;
+    }
+
+    auto particleCount = particles.size();
+    if (particleCount == 0) {
+        return;
+    }
+
+    // 2 triangles for every particle
+    for (auto i = int(_particleIndices.size() / 6); i < int(particleCount); ++i) {
+        _particleIndices.insert(_particleIndices.end(), { i * 4, i * 4 + 1, i * 4 + 2, i * 4 + 2, i * 4 + 3, i * 4 });
+    }
+
+    _particleVertices.clear();
+    for (const auto& [x, y, size, color] : particles) {
+        auto halfSize = size / 2;
+        _particleVertices.push_back(SDL_Vertex { SDL_FPoint { x - halfSize, y - halfSize }, color, SDL_FPoint { 0, 0 } });
+        _particleVertices.push_back(SDL_Vertex { SDL_FPoint { x + halfSize, y - halfSize }, color, SDL_FPoint { 0, 0 } });
+        _particleVertices.push_back(SDL_Vertex { SDL_FPoint { x + halfSize, y + halfSize }, color, SDL_FPoint { 0, 0 } });
+        _particleVertices.push_back(SDL_Vertex { SDL_FPoint { x - halfSize, y + halfSize }, color, SDL_FPoint { 0, 0 } });
+    }
+
+    // Geometry without a texture is blended with the draw blend mode
+    SDL_SetRenderDrawBlendMode(_renderer, SDL_BLENDMODE_BLEND);
+    SDL_RenderGeometry(_renderer, nullptr, _particleVertices.data(), int(_particleVertices.size()), _particleIndices.data(), int(particleCount * 6));
+    SDL_SetRenderDrawBlendMode(_renderer, SDL_BLENDMODE_NONE);
+}
+
 void Screen::DrawTexture(const Texture& texture, const SDL_Rect* sourceRect, const SDL_Rect* destRect) const
 {
+    FlushBlitter();
+
     SDL_RenderCopy(_renderer, *texture, sourceRect, destRect);
 }
 
 void Screen::Present() const
 {
+    FlushBlitter();
+
     SDL_RenderPresent(_renderer);
 }
 
 void Screen::DrawText(const std::string& text, const SDL_Rect& textRect, bool useLargeFont, SDL_Color color) const
 {
     TTF_Font* font = useLargeFont ? _bigFont : _smallFont;
+
+    int calculatedWidth, calculatedHeight;
+    TTF_SizeText(font, text.c_str(), &calculatedWidth, &calculatedHeight);
+
+    auto actualWidth = std::min(textRect.w, calculatedWidth);
+    auto offset = (textRect.w - actualWidth) / 2;
+
+    auto actualRect = textRect;
+    actualRect.x += offset;
+    actualRect.w = actualWidth;
+
+    if (IsBlitterDrawing()) {
+        if (const auto* textImage = GetBlitterTextImage(text, useLargeFont, color)) {
+            _blitter->Blit(*textImage, actualRect);
+        }
+
+        return;
+    }
+
     SDL_Surface* textSurface = TTF_RenderText_Solid(font, text.c_str(), color);
     if (!textSurface) {
         std::cerr << "Something went wrong: " << TTF_GetError() << std::endl;
@@ -157,22 +511,17 @@ void Screen::DrawText(const std::string& text, const SDL_Rect& textRect, bool us
 
     SDL_FreeSurface(textSurface);
 
-    int calculatedWidth, calculatedHeight;
-    TTF_SizeText(font, text.c_str(), &calculatedWidth, &calculatedHeight);
-
-    auto actualWidth = std::min(textRect.w, calculatedWidth);
-    auto offset = (textRect.w - actualWidth) / 2;
-
-    auto actualRect = textRect;
-    actualRect.x += offset;
-    actualRect.w = actualWidth;
-
     SDL_RenderCopy(_renderer, textTexture, nullptr, &actualRect);
     SDL_DestroyTexture(textTexture);
 }
 
 void Screen::DrawBackgroundRectangle(const SDL_Rect& rect, SDL_Color color) const
 {
+    if (IsBlitterDrawing()) {
+        _blitter->FillRect(rect, color);
+        return;
+    }
+
     SDL_SetRenderDrawBlendMode(_renderer, SDL_BLENDMODE_BLEND);
 
     SDL_SetRenderDrawColor(_renderer, color.r, color.g, color.b, color.a);
@@ -183,12 +532,21 @@ void Screen::DrawBackgroundRectangle(const SDL_Rect& rect, SDL_Color color) cons
 
 void Screen::DrawButton(const std::string& text, const SDL_Rect& coords, bool isHovered) const
 {
-    DrawTexture(_menuButton, nullptr, &coords);
+    if (IsBlitterDrawing()) {
+        _blitter->Blit(_blitterMenuButtonImage, coords);
+    } else {
+        DrawTexture(_menuButton, nullptr, &coords);
+    }
 
     auto textColor = isHovered ? SDL_Color { 200, 200, 200 } : SDL_Color { 255, 255, 255 };
     DrawText(text, coords, true, textColor);
 }
 
+SDL_Color Screen::GetCellColor(int cellType) const
+{
+    return _cellColors[cellType];
+}
+
 Texture Screen::LoadImage(const std::string& filePath) const
 {
     // Load image at specified path
@@ -200,3 +558,35 @@ Texture Screen::LoadImage(const std::string& filePath) const
 
     return texture;
 }
+
+uint64_t Screen::GetFrameHash() const
+{
+    assert(_mode == Mode::Offscreen);
+
+    // 64 bit FNV-1a of the visible pixels. The pitch might contain padding, so we go row by row
+    uint64_t hash = 14695981039346656037ull;
+    const auto* pixels = static_cast<const uint8_t*>(_offscreenSurface->pixels);
+    const auto rowSize = size_t(_offscreenSurface->w) * _offscreenSurface->format->BytesPerPixel;
+
+    for (int row = 0; row < _offscreenSurface->h; ++row) {
+        const auto* rowStart = pixels + size_t(row) * _offscreenSurface->pitch;
+        for (size_t i = 0; i < rowSize; ++i) {
+            hash ^= rowStart[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    return hash;
+}
+
+bool Screen::SaveFrame(const std::string& filePath) const
+{
+    assert(_mode == Mode::Offscreen);
+
+    if (IMG_SavePNG(_offscreenSurface, filePath.c_str()) != 0) {
+        std::cerr << "Failed to save frame to " << filePath << ". SDL_image Error: " << IMG_GetError() << std::endl;
+        return false;
+    }
+
+    return true;
+}
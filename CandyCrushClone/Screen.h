@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ParticleSystem.h"
+#include "SoftwareBlitter.h"
 #include "SpriteAnimation.h"
 #include "Texture.h"
 #include "Vec2.h"
@@ -9,16 +11,26 @@
 
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 class Screen {
 public:
+    enum class Mode {
+        Windowed,
+        // Renders with the software renderer into an in-memory surface, no display or GPU is needed
+        Offscreen,
+    };
+
     static constexpr int ScreenWidth = 1024;
     static constexpr int ScreenHeight = 560;
+    // Cells are drawn between 0% (destroyed) and 110% (pulsing active cell) of their size, so every size up to this is
+    // scaled in advance with linear filtering, and drawing a cell never has to resample the image
+    static constexpr int MaxPrescaledCellSize = 80;
 
-    static std::unique_ptr<Screen> GetScreen();
+    static std::unique_ptr<Screen> GetScreen(Mode mode = Mode::Windowed);
     ~Screen();
 
     void TerminateWithMessage(const std::string& errorText);
@@ -26,21 +38,49 @@ public:
     void BeginFrame() const;
     void DrawCell(Vec2 coords, int cellType, int sourceSize, int destinationSize) const;
     void DrawDestroyAnimation(Vec2 coords, int size, double progress);
+    // Every particle is a square, they are drawn with one geometry call
+    void DrawParticles(std::span<const ParticleSprite> particles) const;
     void DrawTexture(const Texture& texture, const SDL_Rect* sourceRect, const SDL_Rect* destRect) const;
     void Present() const;
+    // Returns false if the renderer doesn't support changing it
+    bool SetVsyncEnabled(bool isEnabled);
+    // The position of the window on the desktop, nullopt in offscreen mode
+    std::optional<Vec2> GetWindowPosition() const;
 
     void DrawButton(const std::string& text, const SDL_Rect& coords, bool isHovered) const;
     void DrawText(const std::string& text, const SDL_Rect& textRect, bool useLargeFont, SDL_Color color = { 255, 255, 255 }) const;
     void DrawBackgroundRectangle(const SDL_Rect& rect, SDL_Color color = { 50, 50, 50, 100 }) const;
 
     Texture LoadImage(const std::string& filePath) const;
+    // The average color of the cell's image
+    SDL_Color GetCellColor(int cellType) const;
+
+    // When enabled, everything except DrawTexture is recorded into a draw list, rasterized on the CPU in parallel and
+    // uploaded once per frame, at Present or before the first DrawTexture call. threadCount 0 uses every hardware thread
+    void SetSoftwareBlitterEnabled(bool isEnabled, int threadCount = 0);
+    bool IsSoftwareBlitterEnabled() const;
+    const SoftwareBlitter* GetSoftwareBlitter() const;
+
+    // Enabled by default, only meant to be turned off for measuring the scaling cost
+    void SetPrescaledCellsEnabled(bool isEnabled);
+
+    // These can only be used in offscreen mode, after the frame was presented
+    uint64_t GetFrameHash() const;
+    bool SaveFrame(const std::string& filePath) const;
 
 private:
+    Mode _mode = Mode::Windowed;
     SDL_Window* _window = nullptr;
     SDL_Renderer* _renderer = nullptr;
     SDL_Texture* _renderTarget = nullptr;
+    SDL_Surface* _offscreenSurface = nullptr;
 
     std::vector<Texture> _assetImages;
+    // Indexed by the cell type, then by the size - 1
+    std::vector<std::vector<Texture>> _prescaledCellImages;
+    int _cellImageSize = 0;
+    std::vector<SDL_Color> _cellColors;
+    bool _usePrescaledCells = true;
     Texture _backgroundImage;
     Texture _menuButton;
     TTF_Font* _bigFont = nullptr;
@@ -48,6 +88,34 @@ private:
 
     std::unique_ptr<SpriteAnimation> _gravityAnimation;
 
+    // Reused between the frames, the indices only depend on the number of particles
+    mutable std::vector<SDL_Vertex> _particleVertices;
+    mutable std::vector<int> _particleIndices;
+
+    std::unique_ptr<SoftwareBlitter> _blitter;
+    Texture _blitterTexture;
+    BlitterImage _blitterBackgroundImage;
+    std::vector<BlitterImage> _blitterAssetImages;
+    std::vector<std::vector<BlitterImage>> _blitterPrescaledCellImages;
+    std::vector<BlitterImage> _blitterAnimationFrames;
+    BlitterImage _blitterMenuButtonImage;
+    mutable bool _isBlitterFlushed = true;
+
+    struct CachedText {
+        BlitterImage Image;
+        uint64_t LastUsedFrame = 0;
+    };
+
+    // Rendered texts, so they don't have to be rendered and converted in every frame. Texts that were not drawn in
+    // the previous frame are evicted at the beginning of the next one
+    mutable std::unordered_map<std::string, CachedText> _blitterTextCache;
+    mutable uint64_t _frameIndex = 0;
+
     bool Initialize();
     bool LoadAssets();
+    bool LoadBlitterAssets();
+    bool CanUsePrescaledCell(int sourceSize, int destinationSize) const;
+    bool IsBlitterDrawing() const;
+    void FlushBlitter() const;
+    const BlitterImage* GetBlitterTextImage(const std::string& text, bool useLargeFont, SDL_Color color) const;
 };
@@ -0,0 +1,258 @@
+#include "SoakBot.h"
+
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace {
+// nullopt if the platform is not supported
+std::optional<size_t> GetResidentMemoryBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return size_t(counters.WorkingSetSize);
+    }
+#elif defined(__linux__)
+    std::ifstream statm { "/proc/self/statm" };
+    size_t totalPages = 0, residentPages = 0;
+    if (statm >> totalPages >> residentPages) {
+        return residentPages * size_t(sysconf(_SC_PAGESIZE));
+    }
+#endif
+
+    return std::nullopt;
+}
+
+double ToMegabytes(size_t bytes)
+{
+    return double(bytes) / (1024.0 * 1024.0);
+}
+
+Vec2 GetCenter(const SDL_Rect& rect)
+{
+    return Vec2 { rect.x + rect.w / 2, rect.y + rect.h / 2 };
+}
+}
+
+SoakBot::SoakBot(uint64_t durationMs, unsigned int randomSeed)
+    : _durationMs(durationMs)
+    , _randomEngine(randomSeed)
+{
+}
+
+void SoakBot::Update(uint64_t nowMs, MainMenu& menu, GameWorld& gameWorld, bool isPlaying, const InputProcessor& inputProcessor)
+{
+    if (!_startMs) {
+        _startMs = nowMs;
+        _nextActionMs = nowMs + MaxActionDelayMs;
+        _nextReportMs = nowMs + ReportIntervalMs;
+        _startResidentBytes = GetResidentMemoryBytes();
+    }
+
+    // The events pushed in the previous update were dispatched since then
+    _handlerCallCount += inputProcessor.GetLastDispatchStats().HandlerCallCount;
+
+    if (nowMs >= _nextReportMs) {
+        Report(nowMs, inputProcessor);
+        _nextReportMs += ReportIntervalMs;
+    }
+
+    if (nowMs - *_startMs >= _durationMs) {
+        if (!_isQuitPushed) {
+            SDL_Event quit {};
+            quit.type = SDL_QUIT;
+            _isQuitPushed = SDL_PushEvent(&quit) == 1;
+        }
+
+        return;
+    }
+
+    while (!_plannedEvents.empty() && _plannedEvents.front().DueMs <= nowMs) {
+        // The queue of SDL only fills up if the game stopped polling, then the event is retried in the next update
+        if (SDL_PushEvent(&_plannedEvents.front().Event) != 1) {
+            break;
+        }
+
+        _plannedEvents.pop_front();
+    }
+
+    // A new action is only planned when the previous one was pushed completely and the game had time to react
+    if (!_plannedEvents.empty() || nowMs < _nextActionMs) {
+        return;
+    }
+
+    if (isPlaying) {
+        PlanGameAction(nowMs, gameWorld);
+    } else {
+        PlanMenuAction(nowMs, menu);
+    }
+
+    _nextActionMs = nowMs + GetRandomDelay();
+}
+
+void SoakBot::AddUpdateTime(double updateTimeMs)
+{
+    _intervalUpdateTimes.Add(updateTimeMs);
+    _totalUpdateTimes.Add(updateTimeMs);
+}
+
+void SoakBot::PrintSummary(std::ostream& stream) const
+{
+    stream << "Soak: " << _moveCount << " moves in " << _gameCount << " games, " << _handlerCallCount << " input handler calls" << std::endl;
+    stream << "Update times:" << std::endl;
+    _totalUpdateTimes.Print(stream);
+
+    if (_startResidentBytes && _lastResidentBytes) {
+        stream << "Resident memory: " << ToMegabytes(*_startResidentBytes) << " MB at the start, " << ToMegabytes(*_lastResidentBytes) << " MB at the last report" << std::endl;
+    }
+}
+
+void SoakBot::PlanMenuAction(uint64_t nowMs, MainMenu& menu)
+{
+    std::uniform_int_distribution<int> percent { 0, 99 };
+    auto roll = percent(_randomEngine);
+
+    // The leaderboard only has the back button
+    if (auto back = menu.GetButtonPosition(ButtonType::Back)) {
+        PlanClick(nowMs, GetCenter(*back));
+        return;
+    }
+
+    std::optional<SDL_Rect> button;
+    if (roll < 10) {
+        button = menu.GetButtonPosition(ButtonType::Leaderboard);
+    } else if (roll < 15) {
+        button = menu.GetButtonPosition(ButtonType::ToggleMusic);
+    } else if (roll < 60) {
+        button = menu.GetButtonPosition(ButtonType::Resume);
+    }
+
+    if (!button) {
+        button = menu.GetButtonPosition(_gameCount % 2 == 0 ? ButtonType::Classic : ButtonType::QuickDeath);
+        // Only the games whose click is planned below are counted, the menu might not show the button yet
+        if (button) {
+            ++_gameCount;
+        }
+    }
+
+    if (button) {
+        PlanClick(nowMs, GetCenter(*button));
+    }
+}
+
+void SoakBot::PlanGameAction(uint64_t nowMs, GameWorld& gameWorld)
+{
+    if (_movesSincePause >= MovesBetweenPauses) {
+        _movesSincePause = 0;
+        PlanKeyPress(nowMs, SDLK_ESCAPE);
+        return;
+    }
+
+    if (!gameWorld.IsInteractionEnabled()) {
+        return;
+    }
+
+    auto validSwitch = gameWorld.FindValidSwitch();
+    if (!validSwitch) {
+        // The cells are still animating, try again later
+        return;
+    }
+
+    auto from = gameWorld.GetCellCenter(validSwitch->first);
+    auto to = gameWorld.GetCellCenter(validSwitch->second);
+
+    std::uniform_int_distribution<int> percent { 0, 99 };
+    if (percent(_randomEngine) < 70) {
+        PlanDrag(nowMs, from, to);
+    } else {
+        PlanClick(nowMs, from);
+        PlanClick(nowMs + MinActionDelayMs / 2, to);
+    }
+
+    ++_movesSincePause;
+    ++_moveCount;
+}
+
+void SoakBot::PlanClick(uint64_t atMs, Vec2 position)
+{
+    PlanMouseEvent(atMs, SDL_MOUSEMOTION, position, false);
+    PlanMouseEvent(atMs + 10, SDL_MOUSEBUTTONDOWN, position, true);
+    PlanMouseEvent(atMs + 60, SDL_MOUSEBUTTONUP, position, false);
+}
+
+void SoakBot::PlanDrag(uint64_t atMs, Vec2 from, Vec2 to)
+{
+    PlanMouseEvent(atMs, SDL_MOUSEMOTION, from, false);
+    PlanMouseEvent(atMs + 10, SDL_MOUSEBUTTONDOWN, from, true);
+
+    for (int i = 1; i <= DragMotionCount; ++i) {
+        auto progress = float(i) / DragMotionCount;
+        PlanMouseEvent(atMs + 10 + DragDurationMs * i / DragMotionCount, SDL_MOUSEMOTION, from.Lerp(to, progress), true);
+    }
+
+    PlanMouseEvent(atMs + 20 + DragDurationMs, SDL_MOUSEBUTTONUP, to, false);
+}
+
+void SoakBot::PlanKeyPress(uint64_t atMs, SDL_Keycode key)
+{
+    SDL_Event e {};
+    e.type = SDL_KEYDOWN;
+    e.key.state = SDL_PRESSED;
+    e.key.keysym.sym = key;
+    _plannedEvents.push_back(PlannedEvent { atMs, e });
+}
+
+void SoakBot::PlanMouseEvent(uint64_t atMs, uint32_t type, Vec2 position, bool isLeftPressed)
+{
+    SDL_Event e {};
+    e.type = type;
+
+    if (type == SDL_MOUSEMOTION) {
+        e.motion.state = isLeftPressed ? SDL_BUTTON_LMASK : 0;
+        e.motion.x = position.x;
+        e.motion.y = position.y;
+    } else {
+        e.button.button = SDL_BUTTON_LEFT;
+        e.button.state = isLeftPressed ? SDL_PRESSED : SDL_RELEASED;
+        e.button.clicks = 1;
+        e.button.x = position.x;
+        e.button.y = position.y;
+    }
+
+    _plannedEvents.push_back(PlannedEvent { atMs, e });
+}
+
+void SoakBot::Report(uint64_t nowMs, const InputProcessor& inputProcessor)
+{
+    _lastResidentBytes = GetResidentMemoryBytes();
+
+    std::cout << "[soak " << (nowMs - *_startMs) / 60000 << " min] updates: " << _intervalUpdateTimes.GetCount()
+              << ", p50: " << _intervalUpdateTimes.GetPercentile(50) << " ms, p95: " << _intervalUpdateTimes.GetPercentile(95)
+              << " ms, p99: " << _intervalUpdateTimes.GetPercentile(99) << " ms, max: " << _intervalUpdateTimes.GetMax() << " ms";
+
+    if (_startResidentBytes && _lastResidentBytes) {
+        std::cout << ", resident memory: " << ToMegabytes(*_lastResidentBytes) << " MB ("
+                  << ToMegabytes(*_lastResidentBytes) - ToMegabytes(*_startResidentBytes) << " MB since the start)";
+    }
+
+    // A growing subscriber count means that some handlers are never unsubscribed
+    std::cout << ", input subscribers: " << inputProcessor.GetSubscriberCount() << ", handler calls: " << _handlerCallCount
+              << ", moves: " << _moveCount << std::endl;
+
+    _intervalUpdateTimes.Clear();
+}
+
+uint64_t SoakBot::GetRandomDelay()
+{
+    std::uniform_int_distribution<uint64_t> delay { MinActionDelayMs, MaxActionDelayMs };
+    return delay(_randomEngine);
+}
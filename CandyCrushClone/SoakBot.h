@@ -0,0 +1,75 @@
+#pragma once
+
+#include "FramePacer.h"
+#include "GameWorld.h"
+#include "InputProcessor.h"
+#include "MainMenu.h"
+
+#include <SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <ostream>
+#include <random>
+
+// Plays the game for a long time by pushing SDL mouse and key events, so everything from the event queue through the
+// handlers to the rendering and the audio is exercised. It navigates the menus, and drags or clicks the valid switches.
+// Every report interval it prints the update time percentiles, the resident memory and the input handler counts, so
+// leaks and slowdowns show up. The update times are the work of an update from the event handling to the present, or
+// to the publishing of the frame with the simulation thread. The waits between the updates are not included
+class SoakBot {
+public:
+    SoakBot(uint64_t durationMs, unsigned int randomSeed);
+
+    // Call once per update on the thread handling the input, before the events are handled. Pushes SDL_QUIT when the
+    // soak is over
+    void Update(uint64_t nowMs, MainMenu& menu, GameWorld& gameWorld, bool isPlaying, const InputProcessor& inputProcessor);
+    // Call after the work of every update, before waiting for the next one
+    void AddUpdateTime(double updateTimeMs);
+    void PrintSummary(std::ostream& stream) const;
+
+private:
+    struct PlannedEvent {
+        uint64_t DueMs;
+        SDL_Event Event;
+    };
+
+    static constexpr uint64_t ReportIntervalMs = 60 * 1000;
+    static constexpr uint64_t MinActionDelayMs = 250;
+    static constexpr uint64_t MaxActionDelayMs = 600;
+    static constexpr uint64_t DragDurationMs = 90;
+    static constexpr int DragMotionCount = 6;
+    // The game is paused after this many moves, so the menus are exercised during the games as well
+    static constexpr int MovesBetweenPauses = 40;
+
+    uint64_t _durationMs;
+    std::mt19937 _randomEngine;
+
+    std::optional<uint64_t> _startMs;
+    uint64_t _nextActionMs = 0;
+    uint64_t _nextReportMs = 0;
+    bool _isQuitPushed = false;
+    std::deque<PlannedEvent> _plannedEvents;
+
+    int _movesSincePause = 0;
+    uint64_t _moveCount = 0;
+    uint64_t _gameCount = 0;
+    uint64_t _handlerCallCount = 0;
+
+    FrameTimeHistogram _intervalUpdateTimes;
+    FrameTimeHistogram _totalUpdateTimes;
+    std::optional<size_t> _startResidentBytes;
+    std::optional<size_t> _lastResidentBytes;
+
+    void PlanMenuAction(uint64_t nowMs, MainMenu& menu);
+    void PlanGameAction(uint64_t nowMs, GameWorld& gameWorld);
+    void PlanClick(uint64_t atMs, Vec2 position);
+    void PlanDrag(uint64_t atMs, Vec2 from, Vec2 to);
+    void PlanKeyPress(uint64_t atMs, SDL_Keycode key);
+    void PlanMouseEvent(uint64_t atMs, uint32_t type, Vec2 position, bool isLeftPressed);
+
+    void Report(uint64_t nowMs, const InputProcessor& inputProcessor);
+    uint64_t GetRandomDelay();
+};
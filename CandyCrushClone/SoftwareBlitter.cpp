@@ -0,0 +1,347 @@
+#include "SoftwareBlitter.h"
+
+#include <SDL_image.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLITTER_HAS_SSE2
+#include <immintrin.h>
+
+// MSVC can generate AVX2 code for a single function without any extra flags, GCC and Clang need to be told about it
+#if defined(__GNUC__) || defined(__clang__)
+#define BLITTER_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define BLITTER_AVX2_TARGET
+#endif
+#endif
+
+namespace {
+// Premultiplied source over destination: dst = src + dst * (255 - srcAlpha) / 255
+// The division is done with the usual (x + 128 + ((x + 128) >> 8)) >> 8 trick, which is exact for 16 bit values.
+// The SIMD versions below do the exact same computations, so they produce bit identical results
+uint32_t BlendPixel(uint32_t source, uint32_t destination)
+{
+    uint32_t inverseAlpha = 255 - (source >> 24);
+
+    uint32_t redBlue = (destination & 0x00FF00FF) * inverseAlpha + 0x00800080;
+    redBlue = ((redBlue + ((redBlue >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+
+    uint32_t alphaGreen = ((destination >> 8) & 0x00FF00FF) * inverseAlpha + 0x00800080;
+    alphaGreen = (alphaGreen + ((alphaGreen >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+
+    return source + (redBlue | alphaGreen);
+}
+
+void BlendSpanScalar(uint32_t* destination, const uint32_t* source, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        destination[i] = BlendPixel(source[i], destination[i]);
+    }
+}
+
+void BlendColorSpanScalar(uint32_t* destination, uint32_t color, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        destination[i] = BlendPixel(color, destination[i]);
+    }
+}
+
+#ifdef BLITTER_HAS_SSE2
+// Blends 2 pixels, which are already unpacked to 16 bit channels
+__m128i BlendUnpacked(__m128i source, __m128i destination)
+{
+    // Broadcast the alpha channel (the 4th 16 bit lane of every pixel) to all channels of the pixel
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, 0xFF), 0xFF);
+    __m128i inverseAlpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+
+    __m128i product = _mm_add_epi16(_mm_mullo_epi16(destination, inverseAlpha), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+}
+
+__m128i Blend4Pixels(__m128i source, __m128i destination)
+{
+    __m128i zero = _mm_setzero_si128();
+
+    __m128i low = BlendUnpacked(_mm_unpacklo_epi8(source, zero), _mm_unpacklo_epi8(destination, zero));
+    __m128i high = BlendUnpacked(_mm_unpackhi_epi8(source, zero), _mm_unpackhi_epi8(destination, zero));
+
+    return _mm_add_epi8(source, _mm_packus_epi16(low, high));
+}
+
+void BlendSpanSSE2(uint32_t* destination, const uint32_t* source, int count)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i sourcePixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i destinationPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), Blend4Pixels(sourcePixels, destinationPixels));
+    }
+
+    BlendSpanScalar(destination + i, source + i, count - i);
+}
+
+void BlendColorSpanSSE2(uint32_t* destination, uint32_t color, int count)
+{
+    __m128i colorPixels = _mm_set1_epi32(int(color));
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i destinationPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), Blend4Pixels(colorPixels, destinationPixels));
+    }
+
+    BlendColorSpanScalar(destination + i, color, count - i);
+}
+
+// Same as the SSE2 version, just with 8 pixels at once. Unpacking and packing work on the 128 bit lanes separately,
+// so the pixel order is preserved
+BLITTER_AVX2_TARGET __m256i Blend8Pixels(__m256i source, __m256i destination)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i unpackedSources[2] = { _mm256_unpacklo_epi8(source, zero), _mm256_unpackhi_epi8(source, zero) };
+    __m256i unpackedDestinations[2] = { _mm256_unpacklo_epi8(destination, zero), _mm256_unpackhi_epi8(destination, zero) };
+
+    for (int i = 0; i < 2; ++i) {
+        __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(unpackedSources[i], 0xFF), 0xFF);
+        __m256i inverseAlpha = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+
+        __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(unpackedDestinations[i], inverseAlpha), _mm256_set1_epi16(128));
+        unpackedDestinations[i] = _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+    }
+
+    return _mm256_add_epi8(source, _mm256_packus_epi16(unpackedDestinations[0], unpackedDestinations[1]));
+}
+
+BLITTER_AVX2_TARGET void BlendSpanAVX2(uint32_t* destination, const uint32_t* source, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i sourcePixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        __m256i destinationPixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destination + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), Blend8Pixels(sourcePixels, destinationPixels));
+    }
+
+    BlendSpanSSE2(destination + i, source + i, count - i);
+}
+
+BLITTER_AVX2_TARGET void BlendColorSpanAVX2(uint32_t* destination, uint32_t color, int count)
+{
+    __m256i colorPixels = _mm256_set1_epi32(int(color));
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i destinationPixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destination + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), Blend8Pixels(colorPixels, destinationPixels));
+    }
+
+    BlendColorSpanSSE2(destination + i, color, count - i);
+}
+#endif
+
+uint32_t PremultiplyColor(SDL_Color color)
+{
+    auto premultiply = [&color](uint8_t channel) { return uint32_t((channel * color.a + 127) / 255); };
+
+    return (uint32_t(color.a) << 24) | (premultiply(color.r) << 16) | (premultiply(color.g) << 8) | premultiply(color.b);
+}
+}
+
+SoftwareBlitter::SoftwareBlitter(int width, int height, int threadCount)
+    : _width(width)
+    , _height(height)
+    , _tileColumnCount((width + TileWidth - 1) / TileWidth)
+    , _tileRowCount((height + TileHeight - 1) / TileHeight)
+    , _framebuffer(size_t(width) * height, 0xFF000000)
+    , _tileBins(size_t(_tileColumnCount) * _tileRowCount)
+    , _workerPool(threadCount)
+    , _blendSpan(BlendSpanScalar)
+    , _blendColorSpan(BlendColorSpanScalar)
+{
+    _scaledRows.resize(_workerPool.GetThreadCount(), std::vector<uint32_t>(TileWidth));
+
+#ifdef BLITTER_HAS_SSE2
+    if (SDL_HasAVX2()) {
+        _blendSpan = BlendSpanAVX2;
+        _blendColorSpan = BlendColorSpanAVX2;
+        _implementationName = "AVX2";
+    } else if (SDL_HasSSE2()) {
+        _blendSpan = BlendSpanSSE2;
+        _blendColorSpan = BlendColorSpanSSE2;
+        _implementationName = "SSE2";
+    }
+#endif
+}
+
+std::optional<BlitterImage> SoftwareBlitter::LoadImage(const std::string& filePath, std::optional<SDL_Point> size)
+{
+    SDL_Surface* loadedSurface = IMG_Load(filePath.c_str());
+    if (!loadedSurface) {
+        std::cerr << "Failed to load image. SDL_image Error: " << IMG_GetError() << std::endl;
+        return std::nullopt;
+    }
+
+    if (size && (size->x != loadedSurface->w || size->y != loadedSurface->h)) {
+        SDL_Surface* scaledSurface = SDL_CreateRGBSurfaceWithFormat(0, size->x, size->y, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (scaledSurface) {
+            SDL_SetSurfaceBlendMode(loadedSurface, SDL_BLENDMODE_NONE);
+            SDL_BlitScaled(loadedSurface, nullptr, scaledSurface, nullptr);
+        }
+
+        SDL_FreeSurface(loadedSurface);
+        loadedSurface = scaledSurface;
+    }
+
+    auto image = loadedSurface ? MakeImage(loadedSurface) : std::nullopt;
+    SDL_FreeSurface(loadedSurface);
+
+    if (!image) {
+        std::cerr << "Failed to convert image " << filePath << ". SDL Error: " << SDL_GetError() << std::endl;
+    }
+
+    return image;
+}
+
+std::optional<BlitterImage> SoftwareBlitter::MakeImage(SDL_Surface* surface)
+{
+    // The conversion also turns the color key of palettized surfaces (eg. rendered text) into alpha
+    SDL_Surface* convertedSurface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!convertedSurface) {
+        return std::nullopt;
+    }
+
+    BlitterImage image { convertedSurface->w, convertedSurface->h, std::vector<uint32_t>(size_t(convertedSurface->w) * convertedSurface->h) };
+
+    SDL_PremultiplyAlpha(image.Width, image.Height,
+        SDL_PIXELFORMAT_ARGB8888, convertedSurface->pixels, convertedSurface->pitch,
+        SDL_PIXELFORMAT_ARGB8888, image.Pixels.data(), image.Width * int(sizeof(uint32_t)));
+
+    SDL_FreeSurface(convertedSurface);
+
+    return image;
+}
+
+void SoftwareBlitter::Copy(const BlitterImage& image)
+{
+    assert(image.Width == _width && image.Height == _height);
+
+    _commands.push_back(DrawCommand { DrawCommand::Kind::Copy, SDL_Rect { 0, 0, _width, _height }, &image });
+}
+
+void SoftwareBlitter::Blit(const BlitterImage& image, const SDL_Rect& destination)
+{
+    _commands.push_back(DrawCommand { DrawCommand::Kind::Blit, destination, &image });
+}
+
+void SoftwareBlitter::FillRect(const SDL_Rect& rect, SDL_Color color)
+{
+    _commands.push_back(DrawCommand { DrawCommand::Kind::Fill, rect, nullptr, PremultiplyColor(color) });
+}
+
+void SoftwareBlitter::Rasterize()
+{
+    BinCommands();
+
+    _workerPool.Run(int(_tileBins.size()), [this](int tileIndex, int workerIndex) { RasterizeTile(tileIndex, workerIndex); });
+
+    _commands.clear();
+}
+
+const uint32_t* SoftwareBlitter::GetPixels() const
+{
+    return _framebuffer.data();
+}
+
+int SoftwareBlitter::GetPitch() const
+{
+    return _width * int(sizeof(uint32_t));
+}
+
+const char* SoftwareBlitter::GetImplementationName() const
+{
+    return _implementationName;
+}
+
+int SoftwareBlitter::GetThreadCount() const
+{
+    return _workerPool.GetThreadCount();
+}
+
+void SoftwareBlitter::BinCommands()
+{
+    for (auto& bin : _tileBins) {
+        bin.clear();
+    }
+
+    SDL_Rect framebufferRect { 0, 0, _width, _height };
+
+    for (uint32_t i = 0; i < uint32_t(_commands.size()); ++i) {
+        SDL_Rect clippedRect;
+        if (!SDL_IntersectRect(&_commands[i].Destination, &framebufferRect, &clippedRect)) {
+            continue;
+        }
+
+        int lastTileColumn = (clippedRect.x + clippedRect.w - 1) / TileWidth;
+        int lastTileRow = (clippedRect.y + clippedRect.h - 1) / TileHeight;
+
+        for (int tileRow = clippedRect.y / TileHeight; tileRow <= lastTileRow; ++tileRow) {
+            for (int tileColumn = clippedRect.x / TileWidth; tileColumn <= lastTileColumn; ++tileColumn) {
+                _tileBins[size_t(tileRow) * _tileColumnCount + tileColumn].push_back(i);
+            }
+        }
+    }
+}
+
+void SoftwareBlitter::RasterizeTile(int tileIndex, int workerIndex)
+{
+    int tileX = (tileIndex % _tileColumnCount) * TileWidth;
+    int tileY = (tileIndex / _tileColumnCount) * TileHeight;
+    SDL_Rect tileRect { tileX, tileY, std::min(TileWidth, _width - tileX), std::min(TileHeight, _height - tileY) };
+
+    for (auto commandIndex : _tileBins[tileIndex]) {
+        Execute(_commands[commandIndex], tileRect, _scaledRows[workerIndex]);
+    }
+}
+
+void SoftwareBlitter::Execute(const DrawCommand& command, const SDL_Rect& clipRect, std::vector<uint32_t>& scaledRow)
+{
+    const auto& destination = command.Destination;
+
+    SDL_Rect clippedRect;
+    if (!SDL_IntersectRect(&destination, &clipRect, &clippedRect)) {
+        return;
+    }
+
+    for (int y = clippedRect.y; y < clippedRect.y + clippedRect.h; ++y) {
+        auto* destinationRow = _framebuffer.data() + size_t(y) * _width + clippedRect.x;
+
+        switch (command.CommandKind) {
+        case DrawCommand::Kind::Copy: {
+            const auto* sourceRow = command.Image->Pixels.data() + size_t(y) * _width + clippedRect.x;
+            std::memcpy(destinationRow, sourceRow, clippedRect.w * sizeof(uint32_t));
+        } break;
+        case DrawCommand::Kind::Blit: {
+            const auto& image = *command.Image;
+
+            if (destination.w != image.Width || destination.h != image.Height) {
+                // Nearest neighbor sampling into a temporary row, so the blending itself can still use the SIMD code
+                const auto* sourceRow = image.Pixels.data() + size_t((y - destination.y) * image.Height / destination.h) * image.Width;
+                for (int x = 0; x < clippedRect.w; ++x) {
+                    scaledRow[x] = sourceRow[(clippedRect.x + x - destination.x) * image.Width / destination.w];
+                }
+
+                _blendSpan(destinationRow, scaledRow.data(), clippedRect.w);
+            } else {
+                const auto* sourceRow = image.Pixels.data() + size_t(y - destination.y) * image.Width + (clippedRect.x - destination.x);
+                _blendSpan(destinationRow, sourceRow, clippedRect.w);
+            }
+        } break;
+        case DrawCommand::Kind::Fill: {
+            _blendColorSpan(destinationRow, command.Color, clippedRect.w);
+        } break;
+        }
+    }
+}
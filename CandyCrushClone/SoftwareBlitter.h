@@ -0,0 +1,86 @@
+#pragma once
+
+#include "WorkerPool.h"
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// An image converted to the framebuffer's pixel format (ARGB8888) with premultiplied alpha
+struct BlitterImage {
+    int Width = 0;
+    int Height = 0;
+    std::vector<uint32_t> Pixels;
+};
+
+// Alpha composites images and rectangles into a CPU side framebuffer. Used instead of the SDL renderer when there is
+// no GPU, as SDL's software renderer has to convert and blend every pixel with generic code.
+// The draw calls are only recorded, Rasterize splits the framebuffer into tiles and rasterizes them in parallel.
+// The blending is done with AVX2 or SSE2 when the CPU supports them, all code paths produce the exact same result
+class SoftwareBlitter {
+public:
+    // threadCount is the number of threads used for rasterizing, 0 means the number of hardware threads
+    SoftwareBlitter(int width, int height, int threadCount = 0);
+
+    // If a size is given, the image is scaled to that size during loading
+    static std::optional<BlitterImage> LoadImage(const std::string& filePath, std::optional<SDL_Point> size = std::nullopt);
+    static std::optional<BlitterImage> MakeImage(SDL_Surface* surface);
+
+    // The images have to stay alive until the next Rasterize call
+    void Copy(const BlitterImage& image);
+    void Blit(const BlitterImage& image, const SDL_Rect& destination);
+    void FillRect(const SDL_Rect& rect, SDL_Color color);
+
+    // Executes and clears the recorded draw calls
+    void Rasterize();
+
+    const uint32_t* GetPixels() const;
+    int GetPitch() const;
+    // The instruction set used for blending, eg. "AVX2"
+    const char* GetImplementationName() const;
+    int GetThreadCount() const;
+
+private:
+    using BlendSpanFunction = void (*)(uint32_t* destination, const uint32_t* source, int count);
+    using BlendColorSpanFunction = void (*)(uint32_t* destination, uint32_t color, int count);
+
+    static constexpr int TileWidth = 128;
+    static constexpr int TileHeight = 112;
+
+    struct DrawCommand {
+        enum class Kind {
+            Copy,
+            Blit,
+            Fill,
+        };
+
+        Kind CommandKind;
+        SDL_Rect Destination;
+        const BlitterImage* Image = nullptr;
+        uint32_t Color = 0; // Premultiplied
+    };
+
+    int _width;
+    int _height;
+    int _tileColumnCount;
+    int _tileRowCount;
+    std::vector<uint32_t> _framebuffer;
+
+    std::vector<DrawCommand> _commands;
+    // The indices of the commands that touch the given tile, in draw order
+    std::vector<std::vector<uint32_t>> _tileBins;
+    // Every worker has its own temporary row for scaled images
+    std::vector<std::vector<uint32_t>> _scaledRows;
+    WorkerPool _workerPool;
+
+    BlendSpanFunction _blendSpan;
+    BlendColorSpanFunction _blendColorSpan;
+    const char* _implementationName = "scalar";
+
+    void BinCommands();
+    void RasterizeTile(int tileIndex, int workerIndex);
+    void Execute(const DrawCommand& command, const SDL_Rect& clipRect, std::vector<uint32_t>& scaledRow);
+};
@@ -10,28 +10,41 @@ SpriteAnimation::SpriteAnimation(const std::string& animationDirectory, const Sc
     LoadAssets(animationDirectory);
 }
 
+std::vector<std::string> SpriteAnimation::GetFramePaths(const std::string& animationDirectory)
+{
+    std::vector<std::filesystem::path> paths;
+
+    auto assetPath = std::filesystem::current_path() / animationDirectory;
+    for (auto const& dirEntry : std::filesystem::directory_iterator { assetPath }) {
+        paths.push_back(dirEntry.path());
+    }
+
+    // Sort the iamges based on their name (as we expect the sprite animation frames to be in numbered order)
+    std::sort(paths.begin(), paths.end(), [](const auto& lhs, const auto& rhs) { return lhs.filename().string() < rhs.filename().string(); });
+
+    std::vector<std::string> framePaths;
+    framePaths.reserve(paths.size());
+    std::transform(paths.begin(), paths.end(), std::back_inserter(framePaths), [](const auto& path) { return path.string(); });
+
+    return framePaths;
+}
+
 void SpriteAnimation::Draw(Vec2 location, int frameSize, double progress)
 {
     SDL_Rect dstRect { location.x, location.y, frameSize, frameSize };
 
-    auto indexToDraw = std::min(size_t(progress * _textures.size()), _textures.size() - 1);
+    _screen->DrawTexture(_textures[GetFrameIndex(progress)], nullptr, &dstRect);
+}
 
-    _screen->DrawTexture(_textures[indexToDraw], nullptr, &dstRect);
+size_t SpriteAnimation::GetFrameIndex(double progress) const
+{
+    return std::min(size_t(progress * _textures.size()), _textures.size() - 1);
 }
 
 void SpriteAnimation::LoadAssets(const std::string& animationDirectory)
 {
-    std::vector<std::pair<std::string, Texture>> textures;
-
-    auto assetPath = std::filesystem::current_path() / animationDirectory;
-    for (auto const& dirEntry : std::filesystem::directory_iterator { assetPath }) {
-        auto texture = _screen->LoadImage(dirEntry.path().string());
-        textures.push_back({ dirEntry.path().filename().string(), std::move(texture) });
-    }
-
-    // Sort the iamges based on their name (as we expect the sprite animation frames to be in numbered order)
-    std::sort(textures.begin(), textures.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    auto framePaths = GetFramePaths(animationDirectory);
 
-    _textures.reserve(textures.size());
-    std::transform(textures.begin(), textures.end(), std::back_inserter(_textures), [](auto&& pair) { return std::move(pair.second); });
+    _textures.reserve(framePaths.size());
+    std::transform(framePaths.begin(), framePaths.end(), std::back_inserter(_textures), [this](const auto& path) { return _screen->LoadImage(path); });
 }
@@ -14,7 +14,11 @@ class SpriteAnimation {
 public:
     SpriteAnimation(const std::string& animationDirectory, const Screen& screen);
 
+    // Returns the paths of the animation frames in the order they should be played
+    static std::vector<std::string> GetFramePaths(const std::string& animationDirectory);
+
     void Draw(Vec2 location, int frameSize, double progress);
+    size_t GetFrameIndex(double progress) const;
 
 private:
     const Screen* _screen;
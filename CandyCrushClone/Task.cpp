@@ -0,0 +1,118 @@
+#include "Task.h"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace {
+static constexpr size_t SizeClassGranularity = 64;
+static constexpr size_t SizeClassCount = 32; // Frames up to 2 KiB are pooled
+static constexpr size_t FramesPerChunk = 32;
+
+struct FreeFrame {
+    FreeFrame* Next;
+};
+
+struct FramePoolState {
+    std::array<FreeFrame*, SizeClassCount> FreeLists {};
+    std::vector<std::unique_ptr<std::byte[]>> Chunks;
+    size_t HeapAllocationCount = 0;
+};
+
+thread_local FramePoolState PoolState;
+
+size_t GetSizeClass(size_t size)
+{
+    return (size + SizeClassGranularity - 1) / SizeClassGranularity - 1;
+}
+}
+
+void* CoroutineFramePool::Allocate(size_t size)
+{
+    auto sizeClass = GetSizeClass(size);
+    if (sizeClass >= SizeClassCount) {
+        ++PoolState.HeapAllocationCount;
+        return ::operator new(size);
+    }
+
+    auto& freeList = PoolState.FreeLists[sizeClass];
+    if (!freeList) {
+        // Carve a new chunk into frames of this size class
+        auto frameSize = (sizeClass + 1) * SizeClassGranularity;
+        auto& chunk = PoolState.Chunks.emplace_back(new std::byte[frameSize * FramesPerChunk]);
+        ++PoolState.HeapAllocationCount;
+
+        for (size_t i = 0; i < FramesPerChunk; ++i) {
+            auto* frame = reinterpret_cast<FreeFrame*>(chunk.get() + i * frameSize);
+            frame->Next = freeList;
+            freeList = frame;
+        }
+    }
+
+    auto* frame = freeList;
+    freeList = frame->Next;
+
+    return frame;
+}
+
+void CoroutineFramePool::Free(void* frame, size_t size)
+{
+    auto sizeClass = GetSizeClass(size);
+    if (sizeClass >= SizeClassCount) {
+        ::operator delete(frame);
+        return;
+    }
+
+    auto* freeFrame = static_cast<FreeFrame*>(frame);
+    freeFrame->Next = PoolState.FreeLists[sizeClass];
+    PoolState.FreeLists[sizeClass] = freeFrame;
+}
+
+size_t CoroutineFramePool::GetHeapAllocationCount()
+{
+    return PoolState.HeapAllocationCount;
+}
+
+Task::Task(std::coroutine_handle<promise_type> handle)
+    : _handle(handle)
+{
+}
+
+Task::Task(Task&& other) noexcept
+    : _handle(std::exchange(other._handle, nullptr))
+{
+}
+
+Task& Task::operator=(Task&& other) noexcept
+{
+    if (this != &other) {
+        if (_handle) {
+            _handle.destroy();
+        }
+
+        _handle = std::exchange(other._handle, nullptr);
+    }
+
+    return *this;
+}
+
+Task::~Task()
+{
+    if (_handle) {
+        _handle.destroy();
+    }
+}
+
+void Task::Start()
+{
+    assert(_handle && !_handle.done());
+    _handle.resume();
+}
+
+bool Task::IsDone() const
+{
+    return !_handle || _handle.done();
+}
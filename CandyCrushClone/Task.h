@@ -0,0 +1,100 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+// Hands out coroutine frames from size classes that are kept in free lists, so after warming up starting a coroutine
+// doesn't allocate. Every thread has its own pool, a frame has to be freed on the thread that allocated it
+class CoroutineFramePool {
+public:
+    static void* Allocate(size_t size);
+    static void Free(void* frame, size_t size);
+
+    // The number of times the pool had to go to the heap, either for a new chunk or for an oversized frame
+    static size_t GetHeapAllocationCount();
+};
+
+// A coroutine that does nothing until it is started or awaited. Awaiting a Task runs it and resumes the awaiting
+// coroutine once the Task finished. The coroutine frame is owned by the Task object
+class Task {
+public:
+    struct promise_type {
+        std::coroutine_handle<> Continuation;
+
+        static void* operator new(size_t size)
+        {
+            return CoroutineFramePool::Allocate(size);
+        }
+
+        static void operator delete(void* frame, size_t size)
+        {
+            CoroutineFramePool::Free(frame, size);
+        }
+
+        Task get_return_object()
+        {
+            return Task { std::coroutine_handle<promise_type>::from_promise(*this) };
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        auto final_suspend() noexcept
+        {
+            struct FinalAwaiter {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> finished) noexcept
+                {
+                    auto continuation = finished.promise().Continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+
+                void await_resume() noexcept { }
+            };
+
+            return FinalAwaiter {};
+        }
+
+        void return_void() { }
+
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+
+    Task() = default;
+    Task(Task&& other) noexcept;
+    Task& operator=(Task&& other) noexcept;
+    ~Task();
+
+    // Runs the task until its first suspension point, only for tasks that are not awaited
+    void Start();
+    bool IsDone() const;
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        _handle.promise().Continuation = awaiting;
+        return _handle;
+    }
+
+    void await_resume() noexcept { }
+
+private:
+    std::coroutine_handle<promise_type> _handle;
+
+    explicit Task(std::coroutine_handle<promise_type> handle);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Passes the latest version of a value from one producer thread to one consumer thread without locks. Both sides own
+// a buffer, and the third one is swapped between them atomically. The producer never waits, and the consumer always
+// gets the most recently published buffer, the older ones are skipped
+template <class T>
+class TripleBuffer {
+public:
+    // Producer: the buffer to fill, the consumer doesn't see it until Publish
+    T& GetWriteBuffer()
+    {
+        return _buffers[_writeIndex];
+    }
+
+    void Publish()
+    {
+        auto previous = _sharedIndex.exchange(uint8_t(_writeIndex | NewDataBit), std::memory_order_acq_rel);
+        _writeIndex = previous & IndexMask;
+    }
+
+    // Consumer: returns the latest published buffer, or nullptr if nothing was published since the last call.
+    // The returned buffer stays valid until the next call
+    const T* TryAcquireLatest()
+    {
+        if ((_sharedIndex.load(std::memory_order_relaxed) & NewDataBit) == 0) {
+            return nullptr;
+        }
+
+        auto previous = _sharedIndex.exchange(_readIndex, std::memory_order_acq_rel);
+        _readIndex = previous & IndexMask;
+        return &_buffers[_readIndex];
+    }
+
+private:
+    static constexpr uint8_t NewDataBit = 0x4;
+    static constexpr uint8_t IndexMask = 0x3;
+
+    std::array<T, 3> _buffers;
+    uint8_t _writeIndex = 0;
+    std::atomic<uint8_t> _sharedIndex = 1;
+    uint8_t _readIndex = 2;
+};
@@ -4,12 +4,12 @@
 
 int Vec2::DistanceSquared(const Vec2& other) const
 {
-    return int(std::pow(x - other.x, 2)) + int(std::pow(y - other.y, 2));
+    return (x - other.x) * (x - other.x) + (y - other.y) * (y - other.y);
 }
 
-Vec2 Vec2::Lerp(const Vec2& other, double progress) const
+Vec2 Vec2::Lerp(const Vec2& other, float progress) const
 {
-    return Vec2 { int(std::lerp(x, other.x, progress)), int(std::lerp(y, other.y, progress)) };
+    return Vec2 { int(float(x) + float(other.x - x) * progress), int(float(y) + float(other.y - y) * progress) };
 }
 
 Vec2 Vec2::KeepGreaterComponent() const
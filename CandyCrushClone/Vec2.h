@@ -1,6 +1,7 @@
 #pragma once
 
 #include <compare>
+#include <functional>
 
 struct Vec2 {
     int x;
@@ -9,7 +10,7 @@ struct Vec2 {
     std::strong_ordering operator<=>(const Vec2& other) const = default;
 
     int DistanceSquared(const Vec2& other) const;
-    Vec2 Lerp(const Vec2& other, double progress) const;
+    Vec2 Lerp(const Vec2& other, float progress) const;
     Vec2 KeepGreaterComponent() const;
 };
 
@@ -0,0 +1,97 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threadCount)
+{
+    if (threadCount <= 0) {
+        threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+
+    // The calling thread is worker 0
+    for (int i = 1; i < threadCount; ++i) {
+        _threads.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard lock { _mutex };
+        _shouldStop = true;
+    }
+
+    _batchStarted.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::Run(int taskCount, const Task& task)
+{
+    if (_threads.empty()) {
+        for (int i = 0; i < taskCount; ++i) {
+            task(i, 0);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard lock { _mutex };
+        _task = &task;
+        _taskCount = taskCount;
+        _nextTaskIndex = 0;
+        _busyWorkerCount = int(_threads.size());
+        ++_batchId;
+    }
+
+    _batchStarted.notify_all();
+
+    ExecuteTasks(0);
+
+    // Even if there are no tasks left, some workers might still be executing their last one
+    std::unique_lock lock { _mutex };
+    _batchFinished.wait(lock, [this]() { return _busyWorkerCount == 0; });
+    _task = nullptr;
+}
+
+int WorkerPool::GetThreadCount() const
+{
+    return int(_threads.size()) + 1;
+}
+
+void WorkerPool::WorkerLoop(int workerIndex)
+{
+    uint64_t lastBatchId = 0;
+
+    while (true) {
+        {
+            std::unique_lock lock { _mutex };
+            _batchStarted.wait(lock, [this, lastBatchId]() { return _shouldStop || _batchId != lastBatchId; });
+
+            if (_shouldStop) {
+                return;
+            }
+
+            lastBatchId = _batchId;
+        }
+
+        ExecuteTasks(workerIndex);
+
+        {
+            std::lock_guard lock { _mutex };
+            --_busyWorkerCount;
+        }
+
+        _batchFinished.notify_one();
+    }
+}
+
+void WorkerPool::ExecuteTasks(int workerIndex)
+{
+    for (int taskIndex = _nextTaskIndex++; taskIndex < _taskCount; taskIndex = _nextTaskIndex++) {
+        (*_task)(taskIndex, workerIndex);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads that execute a batch of independent tasks in parallel.
+// The calling thread works on the batch as well and Run only returns once every task of the batch is done
+class WorkerPool {
+public:
+    using Task = std::function<void(int taskIndex, int workerIndex)>;
+
+    // threadCount includes the calling thread, 0 means the number of hardware threads
+    explicit WorkerPool(int threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool& other) = delete;
+    WorkerPool& operator=(const WorkerPool& other) = delete;
+
+    void Run(int taskCount, const Task& task);
+    int GetThreadCount() const;
+
+private:
+    std::vector<std::thread> _threads;
+
+    std::mutex _mutex;
+    std::condition_variable _batchStarted;
+    std::condition_variable _batchFinished;
+
+    const Task* _task = nullptr;
+    int _taskCount = 0;
+    uint64_t _batchId = 0;
+    int _busyWorkerCount = 0;
+    bool _shouldStop = false;
+    std::atomic<int> _nextTaskIndex = 0;
+
+    void WorkerLoop(int workerIndex);
+    void ExecuteTasks(int workerIndex);
+};
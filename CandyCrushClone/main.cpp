@@ -1,10 +1,167 @@
 #include "Game.h"
+#include "Microbenchmarks.h"
+#include "RenderBenchmark.h"
 
 #include <SDL.h>
 
-int main(int arg, char* argv[])
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+static constexpr const char* const DefaultGoldenFilePath = "./render_golden.txt";
+
+bool HasFlag(const std::vector<std::string>& arguments, const std::string& flag)
+{
+    return std::find(arguments.begin(), arguments.end(), flag) != arguments.end();
+}
+
+std::optional<std::string> GetOption(const std::vector<std::string>& arguments, const std::string& option)
+{
+    auto optionIt = std::find(arguments.begin(), arguments.end(), option);
+    if (optionIt == arguments.end() || optionIt + 1 == arguments.end()) {
+        return std::nullopt;
+    }
+
+    return *(optionIt + 1);
+}
+
+// nullopt unless the whole text is a number
+template <class T>
+std::optional<T> ParseNumber(const std::string& text)
+{
+    T value {};
+    const auto* textEnd = text.data() + text.size();
+    auto [parseEnd, error] = std::from_chars(text.data(), textEnd, value);
+    if (error != std::errc {} || parseEnd != textEnd) {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+// Falls back to the default if the option is missing or isn't a number
+template <class T>
+T GetNumberOption(const std::vector<std::string>& arguments, const std::string& option, T defaultValue)
+{
+    auto text = GetOption(arguments, option);
+    if (!text) {
+        return defaultValue;
+    }
+
+    auto value = ParseNumber<T>(*text);
+    if (!value) {
+        std::cerr << "Invalid value for " << option << ": " << *text << ", using " << defaultValue << std::endl;
+        return defaultValue;
+    }
+
+    return *value;
+}
+
+float GetScaleOption(const std::vector<std::string>& arguments, const std::string& option)
+{
+    auto scale = GetNumberOption(arguments, option, 1.0f);
+    return std::clamp(scale, AnimationSpeed::MinScale, AnimationSpeed::MaxScale);
+}
+
+int RunRenderBenchmark(const std::vector<std::string>& arguments)
 {
-    Game game;
+    auto screen = Screen::GetScreen(Screen::Mode::Offscreen);
+    if (!screen) {
+        std::cerr << "Failed to initialize the offscreen screen" << std::endl;
+        return 1;
+    }
+
+    RenderBenchmark benchmark { *screen };
+    auto mismatchCount = benchmark.Run(
+        GetOption(arguments, "--golden").value_or(DefaultGoldenFilePath),
+        HasFlag(arguments, "--update-golden"),
+        GetOption(arguments, "--dump-frames"));
+
+    return mismatchCount == 0 ? 0 : 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+
+    // Usage: --render-benchmark [--golden <file>] [--update-golden] [--dump-frames <directory>]
+    if (HasFlag(arguments, "--render-benchmark")) {
+        return RunRenderBenchmark(arguments);
+    }
+
+    // Usage: --benchmark <name>, eg. --benchmark easing
+    if (auto benchmarkName = GetOption(arguments, "--benchmark")) {
+        return RunMicrobenchmark(*benchmarkName);
+    }
+
+    GameOptions options;
+    options.UseSoftwareBlitter = HasFlag(arguments, "--software-blitter");
+    options.SoftwareBlitterThreadCount = GetNumberOption(arguments, "--render-threads", 0);
+
+    // Usage: --animation-speed <scale> [--animation-speed-<category> <scale>] [--instant-animations]
+    options.Speed.GlobalScale = GetScaleOption(arguments, "--animation-speed");
+    options.Speed.CategoryScales[size_t(AnimationCategory::Switch)] = GetScaleOption(arguments, "--animation-speed-switch");
+    options.Speed.CategoryScales[size_t(AnimationCategory::Destroy)] = GetScaleOption(arguments, "--animation-speed-destroy");
+    options.Speed.CategoryScales[size_t(AnimationCategory::Fall)] = GetScaleOption(arguments, "--animation-speed-fall");
+    options.Speed.CategoryScales[size_t(AnimationCategory::Particles)] = GetScaleOption(arguments, "--animation-speed-particles");
+    options.Speed.IsInstant = HasFlag(arguments, "--instant-animations");
+
+    // Usage: [--fps <rate>] [--vsync] [--frame-stats]
+    options.TargetFps = std::clamp(GetNumberOption(arguments, "--fps", 60), 1, 1000);
+    options.UseVsync = HasFlag(arguments, "--vsync");
+    options.PrintFrameStatistics = HasFlag(arguments, "--frame-stats");
+    options.UseSimulationThread = HasFlag(arguments, "--simulation-thread");
+
+    // Usage: [--latency-overlay] [--latency-histogram <file>]
+    options.ShowLatencyOverlay = HasFlag(arguments, "--latency-overlay");
+    options.LatencyHistogramFilePath = GetOption(arguments, "--latency-histogram");
+
+    options.UseDragPrediction = !HasFlag(arguments, "--no-drag-prediction");
+    options.UseFlickSwitches = !HasFlag(arguments, "--no-flick-switches");
+    options.UsePointerSampling = HasFlag(arguments, "--pointer-sampling");
+
+    // Usage: --soak <minutes>. The headless drivers are used unless SDL_VIDEODRIVER or SDL_AUDIODRIVER selects others
+    if (auto soakMinutesText = GetOption(arguments, "--soak")) {
+        auto soakMinutes = ParseNumber<int>(*soakMinutesText);
+        if (!soakMinutes) {
+            std::cerr << "Invalid value for --soak: " << *soakMinutesText << ". Usage: --soak <minutes>" << std::endl;
+            return 1;
+        }
+
+        options.SoakMinutes = std::max(*soakMinutes, 1);
+        // The bot pushes motion events, which the pointer sampler would replace
+        options.UsePointerSampling = false;
+
+        SDL_SetHintWithPriority(SDL_HINT_VIDEODRIVER, "offscreen", SDL_HINT_DEFAULT);
+        SDL_SetHintWithPriority(SDL_HINT_AUDIODRIVER, "dummy", SDL_HINT_DEFAULT);
+    }
+
+    // Usage: --record-input <file> | --replay-input <file>
+    options.InputRecordingFilePath = GetOption(arguments, "--record-input");
+    if (auto replayFilePath = GetOption(arguments, "--replay-input")) {
+        auto replay = InputReplay::Load(*replayFilePath);
+        if (!replay) {
+            return 1;
+        }
+
+        // The replay starts like the recorded game did, and isn't recorded again
+        options.Seeds = replay->GetSeeds();
+        options.Speed = replay->GetAnimationSpeed();
+        options.InputRecordingFilePath.reset();
+        options.IsHeadless = true;
+
+        Game game { options };
+        game.RunReplay(*replay);
+
+        return 0;
+    }
+
+    Game game { options };
     game.RunMainLoop();
 
     return 0;